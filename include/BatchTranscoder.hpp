@@ -0,0 +1,113 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "VoiceEngine.hpp"
+
+// -------- Toplu WAV -> Opus dönüştürme --------
+// Anons/prompt kütüphanelerini önceden encode etmek için. Her frame headless bir
+// VoiceEngine'in gönderim yolundan (NS/AGC -> Opus, canlı yolla aynı ayarlar) geçer;
+// VAD kapalı, dosyanın tamamı encode edilir. Dosyalar ve uzun dosyaların parçaları tüm
+// çekirdeklere dağıtılır. Her parça overlapSec kadar önceden başlar: ısınma frame'leri
+// NS/AGC kazancını ve encoder durumunu oturtur, paketleri çıktıya girmez; böylece parça
+// sınırları tek parça encode'dan duyulur şekilde ayrışmaz.
+
+// Bellek eşlemeli (mmap) PCM16 WAV okuyucu; stereo mono'ya indirilir.
+class WavFile {
+public:
+    WavFile() = default;
+    WavFile(const WavFile&) = delete;
+    WavFile& operator=(const WavFile&) = delete;
+    ~WavFile() { close(); }
+
+    bool open(const std::string& path, std::string& err);
+    void close();
+
+    int       sampleRate() const { return sampleRate_; }
+    int       channels() const { return channels_; }
+    long long samples() const { return samples_; }   // kanal başına
+    double    seconds() const { return sampleRate_ ? (double)samples_ / sampleRate_ : 0; }
+    // pos'tan n mono örnek; dosya sonunun ötesi sıfırla doldurulur.
+    void read(long long pos, int16_t* out, int n) const;
+
+private:
+    void*  map_ = nullptr;
+    size_t mapLen_ = 0;
+    const uint8_t* data_ = nullptr;
+    int sampleRate_ = 0, channels_ = 0;
+    long long samples_ = 0;
+};
+
+// Tek akışlı, mono Ogg/Opus (RFC 7845) yazıcı. Sayfa başına en fazla ~1 s ses.
+class OggOpusWriter {
+public:
+    ~OggOpusWriter() { if (f_) std::fclose(f_); }
+    // preSkip48k: encoder gecikmesi (OPUS_GET_LOOKAHEAD, 48 kHz'e ölçeklenmiş).
+    bool open(const std::string& path, int inputRate, uint32_t serial, int preSkip48k);
+    // samples48k: paketin 48 kHz'deki süresi.
+    bool writePacket(const uint8_t* pkt, size_t len, int samples48k);
+    // totalSamples48k: kaynağın gerçek uzunluğu; son frame'in dolgusu çalınmaz.
+    bool close(int64_t totalSamples48k);
+
+private:
+    std::FILE* f_ = nullptr;
+    uint32_t serial_ = 0, pageSeq_ = 0;
+    int      preSkip_ = 0;
+    int64_t  granule_ = 0;                 // yazılan paketlerin sonu (pre-skip dahil)
+    std::vector<uint8_t> body_, lacing_;   // açık sayfa
+    int      pagePackets_ = 0, pageSamples_ = 0;
+    bool     ok_ = true;
+
+    bool flushPage(uint8_t flags, int64_t granule);
+};
+
+struct TranscodeParams {
+    enum Format { OGG, RAW };
+    // Opus frame süreleri; 2.5 ms frameMs (tamsayı) ile ifade edilemediğinden desteklenmez.
+    static bool validFrameMs(int ms) { return ms == 5 || ms == 10 || ms == 20 || ms == 40 || ms == 60; }
+    VoiceParams voice;          // bitrate/FEC/NS/AGC: VoiceEngine varsayılanları
+    int    complexity = 10;     // governor bu değere sabitlenir (offline: CPU bol)
+    Format format = OGG;
+    int    threads = 0;         // 0: hardware_concurrency
+    double chunkSec = 30;       // bundan uzun dosyalar parçalanır
+    double overlapSec = 1.0;    // parça başına ısınma
+};
+
+struct TranscodeResult {
+    std::string input, output;
+    bool     ok = false;
+    std::string error;
+    double   audioSec = 0;
+    double   cpuSec = 0;        // parçaların toplam işlem süresi (tek çekirdek)
+    int      chunks = 0;
+    uint64_t packets = 0;
+    uint64_t bytes = 0;         // Opus payload toplamı
+    double   rtf() const { return audioSec > 0 ? cpuSec / audioSec : 0; }
+};
+
+// RAW çıktı: "LMOP" | u16 sürüm=1 | u16 frameMs | u32 sampleRate | u32 paket sayısı,
+// ardından her frame için u16 uzunluk + Opus payload (little-endian).
+class BatchTranscoder {
+public:
+    explicit BatchTranscoder(const TranscodeParams& tp) : tp_(tp) {}
+
+    // outDir boşsa çıktı girişin yanına yazılır (.opus / .lmop). onDone her dosya
+    // bittiğinde worker thread'den (sıralı, kilit altında) çağrılır.
+    std::vector<TranscodeResult> run(const std::vector<std::string>& inputs, const std::string& outDir,
+                                     std::function<void(const TranscodeResult&)> onDone = {});
+
+    static std::string outputPath(const std::string& input, const std::string& outDir,
+                                  TranscodeParams::Format fmt);
+
+private:
+    TranscodeParams tp_;
+
+    bool encodeChunk(const WavFile& wav, long long firstFrame, long long endFrame,
+                     std::vector<std::vector<uint8_t>>& out, std::string& err) const;
+    bool writeOutput(const WavFile& wav, const std::vector<std::vector<std::vector<uint8_t>>>& chunks,
+                     int preSkip48k, TranscodeResult& res) const;
+};
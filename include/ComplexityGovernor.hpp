@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+#include <mutex>
+
+// -------- Encoder complexity governor --------
+// Frame başına encode/decode süresini ve host CPU yükünü ölçer; Opus complexity'sini
+// (ve istenirse bant genişliğini) histerezisle ayarlayarak frame başına CPU bütçesinde kalır.
+struct GovernorParams {
+    bool   enabled = true;
+    double budgetUs = 0;        // frame başına encode+decode bütçesi; 0 -> frameMs'in budgetFrac'ı
+    double budgetFrac = 0.15;
+    int    minComplexity = 0;
+    int    maxComplexity = 10;
+    int    startComplexity = 5;
+    bool   adaptBandwidth = false;
+    int    windowFrames = 50;   // karar penceresi (20ms'de 1 s)
+    int    upHoldWindows = 3;   // artırmak için art arda "rahat" pencere sayısı
+};
+
+// Bant genişliği seviyeleri (OPUS_BANDWIDTH_NARROWBAND + seviye)
+enum : int { BW_NARROW = 0, BW_MEDIUM = 1, BW_WIDE = 2, BW_SUPERWIDE = 3, BW_FULL = 4 };
+
+struct GovernorStats {
+    int    complexity = 5;
+    int    bandwidth = BW_FULL;
+    double encodeUs = 0;        // son pencere ortalaması
+    double decodeUs = 0;
+    double peakUs = 0;          // son penceredeki en kötü frame (encode+decode)
+    double budgetUs = 0;
+    double cpuBusy = -1;        // host CPU meşguliyeti 0..1, bilinmiyorsa <0
+    uint64_t changes = 0;
+};
+
+class ComplexityGovernor {
+public:
+    // Parametreler doğrulanır: complexity 0..10'a kırpılır, min>max ise yer değiştirir.
+    // Bant genişliği tavanı sampleRate'in doğal bandıdır (16k -> WB).
+    void configure(const GovernorParams& gp, int frameMs, int sampleRate = 48000);
+    void onEncode(double us);
+    void onDecode(double us);
+    // Encode edilmeyen (VAD sessiz) frame: biriken decode süresi tepeye katılıp sıfırlanır.
+    void onSilentFrame();
+    // Pencere kapanınca karar verir; ayar değiştiyse true döner.
+    bool update(int& complexity, int& bandwidth);
+    GovernorStats stats() const;
+
+    // Süreç genelinde önbellekli /proc/stat örneklemesi (binlerce oturum tek okuma paylaşır).
+    static double hostCpuBusy();
+    // sampleRate'in taşıyabildiği en geniş Opus bandı (BW_*).
+    static int nativeBandwidth(int sampleRate);
+
+private:
+    GovernorParams gp_;
+    double budgetUs_ = 3000;
+    int complexity_ = 5;
+    int bandwidth_ = BW_FULL;
+    int maxBandwidth_ = BW_FULL;
+
+    // pencere birikimleri
+    int    frames_ = 0;
+    double encSum_ = 0, decSum_ = 0, peak_ = 0, curFrame_ = 0;
+    int    decFrames_ = 0;
+    int    calmWindows_ = 0;
+
+    mutable std::mutex m_;
+    GovernorStats st_;
+};
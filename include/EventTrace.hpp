@@ -0,0 +1,93 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// -------- Frame olay izi (timeline) --------
+// Her thread kendi kilitsiz halka tamponuna yazar (tek yazar, üzerine yazan); dump
+// anında tüm halkalar toplanıp Chrome trace JSON'a (chrome://tracing, ui.perfetto.dev)
+// dökülür. Kapalıyken her çağrı tek bir relaxed atomic okumasıdır; LIFEMESH_EVENT_TRACE=0
+// ile derlenirse tamamen kaybolur.
+#ifndef LIFEMESH_EVENT_TRACE
+#define LIFEMESH_EVENT_TRACE 1
+#endif
+
+enum class TraceEv : uint8_t {
+    CAPTURE = 0, // AudioIO::readFrame (süre = cihazda bekleme)
+    PREPROC,     // HPF/NS/AGC/VAD zinciri
+    ENCODE,
+    SEND,        // UdpTransport::send
+    RECV,        // UdpTransport rx thread
+    JB_PUSH,
+    JB_POP,
+    CONCEAL,     // playout anında hazır frame yok
+    DECODE,
+    PLAY,        // AudioIO::writeFrame (süre = cihaza yazma)
+    COUNT
+};
+
+class EventTracer {
+public:
+    static EventTracer& instance();
+
+#if LIFEMESH_EVENT_TRACE
+    static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+#else
+    static constexpr bool enabled() { return false; }
+#endif
+    // ringEvents: thread başına halka kapasitesi (2'nin kuvvetine yuvarlanır).
+    void enable(bool on, size_t ringEvents = 1u << 14);
+    // Çağıran thread'in timeline'da görünecek adı.
+    void setThreadName(const std::string& name);
+
+    static uint64_t nowNs();
+    // durNs=0: anlık olay. seq: paket seq'i (AudioIO'da cihaz frame sayacı), arg: olaya özgü.
+    void record(TraceEv ev, uint16_t seq, uint64_t startNs, uint64_t durNs, uint32_t arg = 0);
+
+    // Anlık kopya alır; yazan thread'ler durmaz. Olay sayısını döndürür (<0: dosya hatası).
+    long dumpChromeJson(const std::string& path);
+
+private:
+    struct Ring;
+    struct ThreadSlot;
+    EventTracer() = default;
+    static ThreadSlot& threadSlot();
+    Ring* threadRing();
+
+    static std::atomic<bool> enabled_;
+    std::mutex m_;                              // sadece kayıt/dump
+    std::vector<std::unique_ptr<Ring>> rings_;  // thread bitince yeniden kullanılır
+    std::map<uint32_t, std::string> names_;     // tid -> thread adı
+    size_t ringEvents_ = 1u << 14;
+    uint64_t originNs_ = 0;
+    std::atomic<uint32_t> nextTid_{1};
+};
+
+// Süreli olay: kapsam sonunda kaydeder. Kapalıyken saat okunmaz.
+class TraceSpan {
+public:
+    TraceSpan(TraceEv ev, uint16_t seq, uint32_t arg = 0)
+    : ev_(ev), seq_(seq), arg_(arg), t0_(EventTracer::enabled() ? EventTracer::nowNs() : 0) {}
+    ~TraceSpan() {
+        if (t0_) EventTracer::instance().record(ev_, seq_, t0_, EventTracer::nowNs() - t0_, arg_);
+    }
+    void setSeq(uint16_t seq) { seq_ = seq; }
+    void setArg(uint32_t arg) { arg_ = arg; }
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+private:
+    TraceEv ev_;
+    uint16_t seq_;
+    uint32_t arg_;
+    uint64_t t0_;
+};
+
+inline void traceInstant(TraceEv ev, uint16_t seq, uint32_t arg = 0) {
+    if (EventTracer::enabled())
+        EventTracer::instance().record(ev, seq, EventTracer::nowNs(), 0, arg);
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// -------- Frame pipeline --------
+// VoiceEngine'in frame başına tamponları ve sıcak döngüleri. Sık kullanılan
+// (sampleRate, frameMs) çiftleri için derleme zamanında sabit boyutlu varyant
+// (std::array, constexpr trip count) seçilir; diğer her şey runtime varyantına düşer.
+// Varyantlar ortak tabandan türemez: FramePipeline std::variant tutar, visit() ile
+// somut tipe bir kez dallanılır ve frame döngüsü o tip için derlenir (sanal çağrı yok).
+constexpr size_t kMaxFramePacket = 512; // MeshVoiceHeader + opus payload
+
+namespace framekernels {
+float rmsFromEnergy(double energy, int n);
+float rmsDynamic(const int16_t* pcm, int n);
+
+// int64 akümülatörlerle tam sonuç; N derleme zamanı sabiti olunca açılır/vektörleşir.
+template<int N>
+inline float rms(const int16_t* pcm){
+    static_assert(N % 4 == 0, "frame size must be a multiple of 4");
+    int64_t a0=0, a1=0, a2=0, a3=0;
+    for (int i=0;i<N;i+=4){
+        a0 += int32_t(pcm[i])  *pcm[i];
+        a1 += int32_t(pcm[i+1])*pcm[i+1];
+        a2 += int32_t(pcm[i+2])*pcm[i+2];
+        a3 += int32_t(pcm[i+3])*pcm[i+3];
+    }
+    return rmsFromEnergy(double(a0+a1+a2+a3), N);
+}
+}
+
+// -------- Derleme zamanında sabitlenmiş varyant --------
+template<int SampleRate, int FrameMs>
+class FixedFramePipeline {
+public:
+    static constexpr int kFrame = SampleRate * FrameMs / 1000;
+    static_assert(kFrame > 0 && kFrame % 4 == 0, "unsupported frame configuration");
+
+    static constexpr int frameSamples() { return kFrame; }
+    int16_t* captureBuf() { return cap_.data(); }
+    int16_t* playoutBuf() { return play_.data(); }
+    uint8_t* packetBuf() { return pkt_.data(); }
+    // Frame enerjisi (RMS); SimpleVAD karar girdisi.
+    float    rms(const int16_t* pcm) const { return framekernels::rms<kFrame>(pcm); }
+
+private:
+    alignas(16) std::array<int16_t, kFrame> cap_{};
+    alignas(16) std::array<int16_t, kFrame> play_{};
+    std::array<uint8_t, kMaxFramePacket> pkt_{};
+};
+
+// -------- Runtime varyantı (fallback) --------
+class DynamicFramePipeline {
+public:
+    explicit DynamicFramePipeline(int frameSamples)
+    : cap_(frameSamples), play_(frameSamples), pkt_(kMaxFramePacket) {}
+
+    int      frameSamples() const { return (int)cap_.size(); }
+    int16_t* captureBuf() { return cap_.data(); }
+    int16_t* playoutBuf() { return play_.data(); }
+    uint8_t* packetBuf() { return pkt_.data(); }
+    float    rms(const int16_t* pcm) const { return framekernels::rmsDynamic(pcm, (int)cap_.size()); }
+
+private:
+    std::vector<int16_t> cap_, play_;
+    std::vector<uint8_t> pkt_;
+};
+
+// -------- Seçim --------
+class FramePipeline {
+public:
+    // Desteklenen konfigürasyonlar için FixedFramePipeline, yoksa DynamicFramePipeline.
+    void configure(int sampleRate, int frameMs);
+
+    // f somut pipeline tipiyle (auto&) çağrılır; dallanma burada bir kez olur.
+    template<class F> decltype(auto) visit(F&& f) { return std::visit(std::forward<F>(f), v_); }
+    template<class F> decltype(auto) visit(F&& f) const { return std::visit(std::forward<F>(f), v_); }
+
+    int      frameSamples() const { return visit([](const auto& p){ return (int)p.frameSamples(); }); }
+    uint8_t* packetBuf() { return visit([](auto& p){ return p.packetBuf(); }); }
+    float    rms(const int16_t* pcm) const { return visit([pcm](const auto& p){ return p.rms(pcm); }); }
+    bool     isFixed() const { return !std::holds_alternative<DynamicFramePipeline>(v_); }
+
+private:
+    std::variant<FixedFramePipeline<16000, 20>,
+                 FixedFramePipeline<48000, 10>,
+                 FixedFramePipeline<48000, 20>,
+                 DynamicFramePipeline> v_;
+};
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Harici kütüphanesiz spektral gürültü bastırıcı (decision-directed Wiener).
+// 2*frame Hann penceresi, %50 overlap-add; gecikme bir frame. Bin başına döngüler
+// SSE/NEON ile vektörize, diğer platformlarda skaler.
+class NoiseSuppressorNative {
+public:
+    bool init(int sampleRate, int frameSize, int suppressDb = -15);
+    void process(int16_t* pcm, int frameSize);
+
+private:
+    int frame_ = 0, win_ = 0, nfft_ = 0, bins_ = 0;
+    float gainFloor_ = 0.18f;
+    int warmup_ = 0;
+
+    std::vector<float> window_;   // win_
+    std::vector<float> inBuf_;    // win_: önceki + şimdiki frame
+    std::vector<float> ola_;      // frame_: bir önceki bloğun kuyruğu
+    std::vector<float> re_, im_;  // nfft_
+    std::vector<float> gainFull_; // nfft_ (aynalanmış)
+    std::vector<float> pw_, smooth_, noise_, gain_, post_; // bins_
+    std::vector<float> cos_, sin_;  // nfft_/2 twiddle
+    std::vector<uint32_t> rev_;     // bit-reverse permütasyonu
+
+    void fft(bool inverse);
+};
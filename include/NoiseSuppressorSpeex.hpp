@@ -1,18 +1,24 @@
 #pragma once
 #include <cstdint>
 #include <vector>
-#include <speex/speex_preprocess.h>
+
+// SpeexDSP opsiyonel: başlık burada include edilmez, LIFEMESH_HAVE_SPEEXDSP yoksa init() false döner.
+struct SpeexPreprocessState_;
 
 class NoiseSuppressorSpeex {
 public:
     NoiseSuppressorSpeex();
     ~NoiseSuppressorSpeex();
 
-    bool init(int sampleRate, int frameSize, bool enableAgc, int agcTarget);
+    // suppressDb: gürültü bastırma (negatif dB). agcTarget: Speex'in genlik hedefi
+    // (<=0: 16000), agcMaxGainDb: AGC'nin en fazla kazancı.
+    bool init(int sampleRate, int frameSize, int suppressDb, bool enableAgc, int agcTarget, int agcMaxGainDb);
     void process(int16_t* pcm, int frameSize);
 
+    static bool available();
+
 private:
-    SpeexPreprocessState* st_ = nullptr;
+    SpeexPreprocessState_* st_ = nullptr;
     int sampleRate_ = 16000;
     int frameSize_ = 320;
 };
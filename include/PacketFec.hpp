@@ -0,0 +1,139 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "VoiceEngine.hpp"
+
+// -------- Paket seviyesinde parity FEC --------
+// VoiceEngine ile ITransport arasına girer. Medya paketleri aynen geçer; her k paketlik
+// gruba m parity paketi eklenir (m=1 XOR, m>1 GF(256) Cauchy Reed-Solomon). Interleave
+// derinliği D ile ardışık paketler D farklı gruba dağıtılır, D uzunluğa kadar burst
+// her grupta tek kayba iner. Alıcı eksik paketleri jitter buffer'a girmeden kurtarır ve
+// ölçtüğü kayıp/burst desenini karşı tarafa rapor eder; gönderici korumayı buna göre ayarlar.
+
+#pragma pack(push,1)
+struct FecParityHeader {
+    uint16_t baseSeq = 0;   // grubun ilk medya seq'i
+    uint8_t  k = 0;         // gruptaki medya paketi sayısı
+    uint8_t  m = 0;         // gruptaki parity paketi sayısı
+    uint8_t  index = 0;     // bu parity'nin satırı (0..m-1)
+    uint8_t  stride = 1;    // grup üyeleri arası seq farkı (interleave derinliği)
+    uint8_t  coding = 0;    // 0=XOR, 1=Reed-Solomon (Cauchy)
+    uint8_t  reserved = 0;
+    uint16_t len = 0;       // parity blok uzunluğu (2 bayt uzunluk öneki dahil)
+};
+struct FecReport {
+    uint16_t lossPermille = 0;  // ham kanal kaybı (FEC öncesi)
+    uint16_t received = 0;
+    uint8_t  maxBurst = 0;
+    uint8_t  meanBurstX10 = 0;
+};
+#pragma pack(pop)
+
+struct FecParams {
+    enum Coding : uint8_t { XOR = 0, RS = 1 };
+    bool    enabled = true;
+    bool    adaptive = true;   // raporlarla k/m/D ayarla (kapalıysa sabit parametreler)
+    Coding  coding = XOR;
+    int     k = 8;
+    int     m = 1;
+    int     interleave = 1;
+    int     maxInterleave = 4;
+    int     maxParity = 3;
+    int     reportMs = 1000;
+    // Parity grubun son üyesinden sonra gider: ilk üye (k-1)*D frame bekler. k/D (sabit
+    // parametreler dahil) bu gecikme playout bütçesine sığacak şekilde küçültülür.
+    int     maxDelayMs = 120;
+    int     frameMs = 20;
+};
+
+struct FecStats {
+    bool     active = false;   // şu an parity gönderiliyor mu
+    int      k = 0, m = 0, interleave = 0;
+    uint64_t paritySent = 0;
+    uint64_t recovered = 0;
+    uint64_t recoveredLate = 0; // recovered'ın playout bütçesinden geç olanları (yine iletilir:
+                                // jitter buffer eksik seq'i bekler, eskiyse kendisi atar)
+    uint64_t unrecoverable = 0; // parity geldi ama eksikler fazlaydı
+    double   peerLoss = 0;      // alıcı raporlarının en kötüsü (son iki rapor aralığı)
+    int      peerMaxBurst = 0;
+};
+
+class FecTransport : public ITransport {
+public:
+    FecTransport(ITransport* inner, const FecParams& fp);
+
+    bool send(const uint8_t* data, size_t len) override;
+    void onReceive(RxHandler h) override;
+    uint64_t lastRxTimestampNs() const override { return inner_->lastRxTimestampNs(); }
+    // Parity ek yükünü (k+m)/k ekleyip içeri iletir.
+    void setSendRate(int bps) override;
+
+    FecStats stats() const;
+
+private:
+    static constexpr size_t RING = 1024;
+
+    ITransport* inner_;
+    FecParams fp_;
+    RxHandler rx_;
+
+    // ---- gönderici (send thread + rapor işleyen rx thread)
+    mutable std::mutex txMu_;
+    bool     txActive_;
+    int      txK_, txM_, txD_;
+    FecParams::Coding txCoding_;
+    bool     blockSet_ = false;
+    uint16_t blockStart_ = 0;
+    std::vector<std::vector<uint8_t>> txUnits_;  // D*k birim, blok içi sıra
+    std::vector<uint8_t> parityBuf_;
+
+    // ---- rapor birleştirme (rx thread): pencere başına en kötü kayıp/burst
+    bool     repWinSet_ = false;
+    uint32_t repWinStartMs_ = 0;
+    uint16_t winLoss_ = 0, prevLoss_ = 0;
+    uint8_t  winBurst_ = 0, prevBurst_ = 0;
+    int      cleanWindows_ = 0;   // art arda temiz kapanan pencere
+
+    // ---- alıcı (sadece rx thread)
+    // pkt kapasitesi ilk kullanımda bir kez ayrılır; sürekli akışta allocation yok.
+    // lost: seq atlanırken kayıp sayıldı; geç gelirse sayaçtan bir kez düşülür.
+    struct Slot { bool valid = false; bool lost = false; uint16_t seq = 0; std::vector<uint8_t> pkt; };
+    std::vector<Slot> ring_;
+    struct ParityGroup {
+        uint8_t k = 0, m = 0, stride = 1, coding = 0;
+        uint16_t len = 0;
+        bool done = false;
+        std::map<uint8_t, std::vector<uint8_t>> rows;
+    };
+    std::map<uint16_t, ParityGroup> groups_;  // baseSeq -> grup
+    uint32_t convId_ = 0;
+
+    // kayıp ölçümü (rapor aralığı)
+    bool     haveLast_ = false;
+    uint16_t lastSeq_ = 0;
+    uint32_t intervalRx_ = 0, intervalLost_ = 0, burstCount_ = 0, burstSum_ = 0;
+    uint8_t  maxBurst_ = 0;
+    uint32_t lastReportMs_ = 0;
+
+    std::atomic<uint64_t> paritySent_{0}, recovered_{0}, recoveredLate_{0}, unrecoverable_{0};
+    std::atomic<uint16_t> peerLossPermille_{0};
+    std::atomic<uint8_t>  peerMaxBurst_{0};
+    std::atomic<int>      baseRateBps_{0};  // engine'in son bildirdiği hız
+
+    void onInnerRx(const uint8_t* data, size_t len);
+    void onMedia(const MeshVoiceHeader& hdr, const uint8_t* data, size_t len);
+    void onParity(const uint8_t* data, size_t len);
+    void onReport(const FecReport& rep);
+    void tryRecover(uint16_t baseSeq, ParityGroup& g);
+    void storeMedia(uint16_t seq, const uint8_t* data, size_t len);
+    void maybeSendReport(uint32_t nowMs);
+    void emitParity(int group, uint32_t tsMs);
+    void forwardRate();
+    int  delayFrames() const;
+    bool fitDelay(int& k, int& d) const;
+};
@@ -0,0 +1,108 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "VoiceEngine.hpp"
+
+// -------- Gönderim pacing'i --------
+// ITransport'un önüne girer (engine -> FEC -> pacer -> UDP). Paketler sınıflara ayrılır;
+// her sınıfın kendi token bucket'ı var ve hepsi ayrıca toplam hız kovasından geçer.
+// Canlı ses (media) katı önceliklidir: kuyruğu boşsa ve token varsa çağıran thread'de hemen
+// gider, diğer sınıflar ancak media kuyruğu boşken kalan token'ları kullanır. Kuyruğa
+// düşenler flushMs periyotlu timer ile toplu boşaltılır; paket başına uyanma yok, kuyruk
+// boşken thread uyur. Toplam hız = congestion controller hedefi (setSendRate) x pacingFactor.
+// inner_->send kilit dışında çağrılır: token kilit altında düşülür, paket sonra gönderilir.
+
+enum class PaceClass : uint8_t {
+    MEDIA = 0,  // yerel canlı ses (hop=0)
+    CONTROL,    // FEC alıcı raporu vb.
+    FEC,        // parity
+    RELAY,      // başka düğümden iletilen ses (hop>0)
+    PROBE,      // MeshVoiceHeader taşımayan datagramlar (ölçüm/probe)
+    COUNT
+};
+constexpr int PACE_CLASSES = (int)PaceClass::COUNT;
+
+struct PacerParams {
+    bool   enabled = true;
+    double pacingFactor = 2.5;      // hedefin üstü: kısa dalgalanmada kuyruk birikmesin
+    int    initialRateBps = 64000;  // ilk setSendRate'e kadar toplam hız
+    int    minRateBps = 24000;
+    int    maxRateBps = 2000000;
+    int    flushMs = 5;             // timer periyodu
+    int    burstMs = 10;            // kova derinliği (toplam ve sınıf kovaları)
+    int    mtuBytes = 1400;         // kova derinliğinin alt sınırı: en büyük datagram sığar
+    // sınıf kovası hızı, toplam hızın oranı (MEDIA, CONTROL, FEC, RELAY, PROBE)
+    double share[PACE_CLASSES] = { 1.0, 0.1, 0.5, 0.5, 0.1 };
+    int    mediaMaxDelayMs = 60;    // bundan eski ses paketi düşer (alıcıda zaten geç kalır)
+    int    maxDelayMs = 500;        // diğer sınıflar için aynı sınır
+    size_t maxQueuePackets = 256;   // sınıf başına; dolunca en eski düşer
+};
+
+struct PacerStats {
+    int      rateBps = 0;
+    uint64_t sent[PACE_CLASSES] = {};
+    uint64_t queued[PACE_CLASSES] = {};   // hemen gidemeyip kuyruğa düşen
+    uint64_t dropped[PACE_CLASSES] = {};
+    size_t   backlog = 0;                 // şu an kuyrukta bekleyen paket
+    double   maxWaitMs = 0;               // son stats() çağrısından beri en uzun bekleme
+    uint64_t flushes = 0;
+};
+
+class PacerTransport : public ITransport {
+public:
+    PacerTransport(ITransport* inner, const PacerParams& pp);
+    ~PacerTransport() override { stop(); }
+
+    bool start();
+    void stop();
+
+    bool send(const uint8_t* data, size_t len) override;
+    void onReceive(RxHandler h) override { inner_->onReceive(std::move(h)); }
+    uint64_t lastRxTimestampNs() const override { return inner_->lastRxTimestampNs(); }
+    void setSendRate(int bps) override;
+
+    static PaceClass classify(const uint8_t* data, size_t len);
+    // maxWaitMs'i sıfırlar.
+    PacerStats stats();
+
+private:
+    struct Pending { uint64_t enqNs; std::vector<uint8_t> pkt; };
+    struct Bucket { double tokens = 0, depth = 0, rateBps = 0; };
+
+    ITransport* inner_;
+    PacerParams pp_;
+
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::thread th_;
+    bool running_ = false;
+
+    int      rateBps_;
+    Bucket   link_;
+    Bucket   cls_[PACE_CLASSES];
+    uint64_t lastRefillNs_ = 0;
+    std::deque<Pending> q_[PACE_CLASSES];
+    size_t   backlog_ = 0;
+    std::vector<std::vector<uint8_t>> spare_;   // tampon geri dönüşümü
+    std::vector<Pending> batch_;                // flush'ta kilit dışında gönderilecekler
+    bool     sending_ = false;                  // batch_ kilit dışında gönderiliyor
+    bool     deferred_ = false;                 // o sırada gelen paket kuyruğa alındı
+
+    uint64_t sent_[PACE_CLASSES] = {}, queued_[PACE_CLASSES] = {}, dropped_[PACE_CLASSES] = {};
+    uint64_t maxWaitNs_ = 0, flushes_ = 0;
+
+    void applyRate();
+    void refill(uint64_t nowNs);
+    bool canSend(int c, size_t len) const;
+    void consume(int c, size_t len);
+    void flush(uint64_t nowNs);
+    void sendBatch(std::unique_lock<std::mutex>& lk);
+    void flushLoop();
+};
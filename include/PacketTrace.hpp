@@ -0,0 +1,85 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "VoiceEngine.hpp"
+
+// -------- Paket iz (trace) dosya formatı --------
+// [PacketTraceFileHeader] ardından tekrar eden [PacketTraceRecord + len bayt datagram].
+// Tüm alanlar host byte order (MeshVoiceHeader ile aynı), zaman damgaları steady_clock ns.
+#pragma pack(push,1)
+struct PacketTraceFileHeader {
+    uint32_t magic   = 0x54504D4C; // "LMPT"
+    uint16_t version = 1;
+    uint16_t reserved = 0;
+    uint64_t startNs = 0;          // kayıt başlangıcı (steady_clock)
+};
+struct PacketTraceRecord {
+    uint64_t tsNs  = 0;            // varış/gönderim zamanı (steady_clock ns)
+    uint8_t  dir   = 0;            // 0=RX, 1=TX
+    uint8_t  clock = 0;            // 0=steady_clock, 1=kernel (SO_TIMESTAMPNS, steady'ye çevrildi)
+    uint16_t len   = 0;
+};
+#pragma pack(pop)
+
+enum : uint8_t { TRACE_DIR_RX = 0, TRACE_DIR_TX = 1 };
+enum : uint8_t { TRACE_CLOCK_STEADY = 0, TRACE_CLOCK_KERNEL = 1 };
+
+struct TracedPacket {
+    uint64_t tsNs = 0;
+    uint8_t  dir = TRACE_DIR_RX;
+    uint8_t  clock = TRACE_CLOCK_STEADY;
+    std::vector<uint8_t> data;
+};
+
+// -------- Writer --------
+class PacketTraceWriter {
+public:
+    ~PacketTraceWriter();
+    bool open(const std::string& path);
+    void close();
+    // RX thread ve pollOnce thread'inden aynı anda çağrılabilir.
+    void record(uint8_t dir, uint8_t clock, uint64_t tsNs, const uint8_t* data, size_t len);
+    uint64_t records() const { return records_; }
+
+    static uint64_t steadyNowNs();
+    // Kernel CLOCK_REALTIME damgasını steady_clock eksenine taşır.
+    static uint64_t kernelToSteadyNs(uint64_t realtimeNs);
+private:
+    std::FILE* f_ = nullptr;
+    std::mutex m_;
+    uint64_t records_ = 0;
+};
+
+// -------- Reader --------
+class PacketTraceReader {
+public:
+    ~PacketTraceReader();
+    // Başarısızsa dosya kapatılır; nesne yeniden open() edilebilir.
+    bool open(const std::string& path);
+    void close();
+    bool next(TracedPacket& out);
+    uint64_t startNs() const { return hdr_.startNs; }
+private:
+    std::FILE* f_ = nullptr;
+    PacketTraceFileHeader hdr_{};
+};
+
+// -------- Transport dekoratörü: her datagramı trace'e yazar --------
+class TraceTransport : public ITransport {
+public:
+    TraceTransport(ITransport* inner, PacketTraceWriter* writer);
+
+    bool send(const uint8_t* data, size_t len) override;
+    void onReceive(RxHandler h) override;
+    uint64_t lastRxTimestampNs() const override { return inner_->lastRxTimestampNs(); }
+    void setSendRate(int bps) override { inner_->setSendRate(bps); }
+private:
+    ITransport* inner_;
+    PacketTraceWriter* w_;
+    RxHandler rx_;
+};
@@ -0,0 +1,40 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// -------- Playout scheduler --------
+// Çıkış cihazının kuyruğunu (Pa_GetStreamWriteAvailable) izler ve her poll'de
+// kuyruğu hedef gecikmede tutacak kadar frame yazdırır; cihaz boşalırsa underrun sayar.
+// Kuyruk = kapasite - writeAvailable; kapasite stream açılırken bir kez alınır.
+// Zamanlayıcı hedefin üstüne hiç yazmadığı için ayrı bir overrun yolu yoktur.
+struct PlayoutParams {
+    int targetMs = 60;   // cihaz kuyruğunda tutulacak ses
+};
+
+struct PlayoutStats {
+    double   queuedMs = 0;   // son ölçülen cihaz kuyruğu
+    long     capacity = 0;   // cihaz tamponu (örnek); 0: bilinmiyor
+    uint64_t framesWritten = 0;
+    uint64_t underruns = 0;
+};
+
+class PlayoutScheduler {
+public:
+    // capacity: boş çıkış tamponunun writeAvailable'ı (AudioIO::outputCapacity); <=0 bilinmiyor.
+    void configure(const PlayoutParams& pp, int sampleRate, int frameSamples, long capacity);
+    // writeAvailable: cihazın şu an bloklamadan kabul edeceği örnek sayısı (<0: bilinmiyor).
+    // Dönüş: bu poll'de yazılması gereken frame sayısı.
+    int framesToWrite(long writeAvailable);
+    void onFrameWritten() { written_++; }
+    PlayoutStats stats() const;
+
+private:
+    int sampleRate_ = 16000, frame_ = 320;
+    long target_ = 960;
+    long capacity_ = 0;
+    bool primed_ = false;
+    bool inUnderrun_ = false;
+
+    std::atomic<double>   queuedMs_{0};
+    std::atomic<uint64_t> written_{0}, underruns_{0};
+};
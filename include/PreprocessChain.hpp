@@ -0,0 +1,154 @@
+#pragma once
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "NoiseSuppressorSpeex.hpp"
+#include "NoiseSuppressorNative.hpp"
+
+class FramePipeline;
+
+// -------- Basit VAD --------
+class SimpleVAD {
+public:
+    void configure(float thRms = 300.0f, int hangMs = 150, int sampleRate = 16000);
+    bool isSpeech(const int16_t* pcm, int n, int sampleRate);
+    // Enerjisi önceden hesaplanmış frame için karar (FramePipeline kernel'leri).
+    bool decide(float rms, int n);
+private:
+    int hangSamples_ = 0, remain_ = 0; float thr_=300.f;
+};
+
+// -------- Ön işleme zinciri --------
+// Capture frame'i yerinde, sırayla aşamalardan geçer (HPF -> NS -> AGC -> VAD).
+// Aşamalar init'te tamponlarını ayırır; process sırasında allocation ve kilit yoktur.
+struct FrameContext {
+    bool speech = true;   // VAD aşaması yoksa frame konuşma sayılır
+};
+
+class IAudioStage {
+public:
+    virtual ~IAudioStage() = default;
+    virtual const char* name() const = 0;
+    virtual bool init(int sampleRate, int frameSamples) = 0;
+    virtual void process(int16_t* pcm, int n, FrameContext& ctx) = 0;
+};
+
+struct PreprocParams {
+    enum NsKind { NS_AUTO, NS_NATIVE, NS_SPEEX, NS_OFF };
+    bool   highPass = false;  // isteğe bağlı (--hpf); varsayılan capture yolu değişmez
+    float  highPassHz = 80.f;
+    NsKind ns = NS_AUTO;      // AUTO: SpeexDSP derlendiyse Speex, değilse native
+    int    nsDb = -15;
+    bool   agc = true;
+    float  agcTargetRms = 3000.f;
+    float  agcMaxGainDb = 20.f;
+    bool   vad = true;
+    float  vadRms = 300.f;
+    int    vadHangMs = 150;
+};
+
+class PreprocessChain {
+public:
+    struct StageTiming {
+        const char* name = "";
+        double   lastUs = 0, avgUs = 0, maxUs = 0;
+        uint64_t frames = 0;
+    };
+
+    void clear();
+    void add(std::unique_ptr<IAudioStage> stage);
+    // init'i başarısız olan aşama zincirden çıkarılır; hepsi açıldıysa true.
+    bool init(int sampleRate, int frameSamples);
+    void process(int16_t* pcm, int n, FrameContext& ctx);
+
+    // Başka thread'den okunabilir; sayaçların anlık görüntüsü.
+    std::vector<StageTiming> timings() const;
+    size_t size() const { return stages_.size(); }
+
+private:
+    // Yalnız process thread'i yazar (relaxed); timings() kilitsiz okur.
+    struct AtomicTiming {
+        std::atomic<double>   lastUs{0}, avgUs{0}, maxUs{0};
+        std::atomic<uint64_t> frames{0};
+    };
+
+    std::vector<std::unique_ptr<IAudioStage>> stages_;
+    std::vector<std::unique_ptr<AtomicTiming>> timing_;
+    mutable std::mutex m_;   // yapı değişiklikleri (clear/add/init) ve timings()
+};
+
+// -------- Hazır aşamalar --------
+class HighPassStage : public IAudioStage {
+public:
+    explicit HighPassStage(float cutoffHz = 80.f) : fc_(cutoffHz) {}
+    const char* name() const override { return "hpf"; }
+    bool init(int sampleRate, int frameSamples) override;
+    void process(int16_t* pcm, int n, FrameContext& ctx) override;
+private:
+    float fc_;
+    float b0_=1, b1_=0, b2_=0, a1_=0, a2_=0; // 2. derece Butterworth (RBJ)
+    float z1_=0, z2_=0;
+};
+
+class NativeNsStage : public IAudioStage {
+public:
+    explicit NativeNsStage(int suppressDb = -15) : db_(suppressDb) {}
+    const char* name() const override { return "ns"; }
+    bool init(int sampleRate, int frameSamples) override { return ns_.init(sampleRate, frameSamples, db_); }
+    void process(int16_t* pcm, int n, FrameContext&) override { ns_.process(pcm, n); }
+private:
+    int db_;
+    NoiseSuppressorNative ns_;
+};
+
+// Speex NS (+ istenirse kendi AGC'si). Ayarlar native NS/AgcStage ile aynı parametrelerden;
+// Speex'in AGC hedefi genlik olduğundan RMS hedefi tepeye (sinüs, x√2) çevrilir.
+class SpeexNsStage : public IAudioStage {
+public:
+    SpeexNsStage(int suppressDb, bool agc, float agcTargetRms = 3000.f, float agcMaxGainDb = 20.f)
+    : db_(suppressDb), agc_(agc), target_((int)std::lround(agcTargetRms * std::sqrt(2.f))),
+      maxGainDb_((int)std::lround(agcMaxGainDb)) {}
+    const char* name() const override { return "speex"; }
+    bool init(int sampleRate, int frameSamples) override {
+        return ns_.init(sampleRate, frameSamples, db_, agc_, target_, maxGainDb_);
+    }
+    void process(int16_t* pcm, int n, FrameContext&) override { ns_.process(pcm, n); }
+private:
+    int  db_;
+    bool agc_;
+    int  target_, maxGainDb_;
+    NoiseSuppressorSpeex ns_;
+};
+
+class AgcStage : public IAudioStage {
+public:
+    AgcStage(float targetRms = 3000.f, float maxGainDb = 20.f)
+    : target_(targetRms), maxGain_(std::pow(10.f, maxGainDb / 20.f)) {}
+    const char* name() const override { return "agc"; }
+    bool init(int, int) override { gain_ = 1.f; return true; }
+    void process(int16_t* pcm, int n, FrameContext& ctx) override;
+private:
+    float target_, maxGain_;
+    float gain_ = 1.f;
+};
+
+// SimpleVAD; enerji varsa FramePipeline'ın sabit boyutlu kernel'iyle hesaplanır.
+class VadStage : public IAudioStage {
+public:
+    VadStage(float thRms, int hangMs, const FramePipeline* pipe = nullptr)
+    : th_(thRms), hangMs_(hangMs), pipe_(pipe) {}
+    const char* name() const override { return "vad"; }
+    bool init(int sampleRate, int frameSamples) override;
+    void process(int16_t* pcm, int n, FrameContext& ctx) override;
+private:
+    float th_; int hangMs_;
+    const FramePipeline* pipe_;
+    SimpleVAD vad_;
+};
+
+// PreprocParams'tan zinciri kurar (init çağırmaz).
+void buildPreprocessChain(PreprocessChain& chain, const PreprocParams& pp, const FramePipeline* pipe);
@@ -0,0 +1,96 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "VoiceEngine.hpp"
+#include "SharedUdpSocket.hpp"
+#include "TimerWheel.hpp"
+
+// -------- Oturum tanımı --------
+struct SessionConfig {
+    VoiceParams vp;
+    uint32_t convId = 0;
+    std::string remoteIp;
+    uint16_t remotePort = 0;
+    bool bypassVad = false;
+    // Her tick'te capture frame'ini doldurur; false dönerse bu tick TX yok (sadece dinleme).
+    std::function<bool(std::vector<int16_t>&)> capture;
+    // Her tick'te bir playout frame'i (decode edilmiş ya da sessizlik).
+    std::function<void(const std::vector<int16_t>&, bool decoded)> playout;
+};
+
+// -------- Çok oturumlu host --------
+// Binlerce headless VoiceEngine tek süreçte: 20 ms tick'ler timer wheel'den küçük bir
+// worker havuzuna dağıtılır, tüm ağ I/O'su SharedUdpSocket'ten geçer ve convId ile
+// oturuma yönlendirilir. Thread sayısı oturum sayısından bağımsızdır.
+class SessionHost {
+public:
+    // workers=0 -> hardware_concurrency
+    SessionHost(uint16_t localPort, int workers = 0, int ioSockets = 1);
+    ~SessionHost();
+
+    bool start();
+    void stop();
+
+    int  addSession(SessionConfig cfg);   // oturum id, hata -> -1
+    void removeSession(int id);
+    size_t sessionCount() const;
+
+    struct Stats {
+        uint64_t ticks = 0;
+        uint64_t lateTicks = 0;   // deadline'dan bir frame'den fazla geç çalışan tick
+        uint32_t maxLateMs = 0;
+        uint64_t txFrames = 0;
+        uint64_t rxFrames = 0;
+    };
+    Stats stats() const;
+
+private:
+    struct Session;
+
+    SharedUdpSocket sock_;
+    int nWorkers_;
+    std::atomic<bool> running_{false};
+
+    // Wheel/kuyruk kayıtları slot | (nesil << SLOT_BITS): slot yeniden kullanılınca
+    // eski oturumun geciken kaydı yeni oturumu tetiklemez.
+    static constexpr uint32_t SLOT_BITS = 20, SLOT_MASK = (1u << SLOT_BITS) - 1;
+
+    mutable std::shared_mutex sessMu_;
+    std::vector<std::shared_ptr<Session>> sessions_;
+    std::vector<uint32_t> slotGen_;     // slot başına nesil sayacı
+    std::vector<uint32_t> freeSlots_;
+    std::unordered_map<uint32_t, uint32_t> byConv_;
+
+    std::mutex wheelMu_;
+    TimerWheel wheel_;
+
+    std::mutex qMu_;
+    std::condition_variable qCv_;
+    std::deque<uint32_t> ready_;
+
+    std::thread timerTh_;
+    std::vector<std::thread> workers_;
+    std::chrono::steady_clock::time_point t0_;
+
+    std::atomic<uint64_t> ticks_{0}, lateTicks_{0};
+    std::atomic<uint32_t> maxLateMs_{0};
+
+    uint64_t nowTick() const;
+    std::shared_ptr<Session> lookup(uint32_t token) const;
+    void onDatagram(const uint8_t* data, size_t len, const sockaddr_in& src);
+    void timerLoop();
+    void workerLoop();
+    void runTick(Session& s);
+};
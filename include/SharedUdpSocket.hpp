@@ -0,0 +1,36 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <netinet/in.h>
+
+// -------- Paylaşımlı UDP soket katmanı --------
+// Aynı porta SO_REUSEPORT ile bağlı N soket; her soketin tek bir RX thread'i var.
+// Çok oturumlu host'ta tüm oturumların I/O'su buradan geçer (oturum başına thread yok).
+class SharedUdpSocket {
+public:
+    using RxHandler = std::function<void(const uint8_t*, size_t, const sockaddr_in&)>;
+
+    SharedUdpSocket(uint16_t localPort, int sockets = 1);
+    ~SharedUdpSocket() { stop(); }
+
+    bool start(RxHandler h);
+    void stop();
+
+    // hint: aynı oturumun paketleri hep aynı soketten çıksın diye (ör. session id).
+    bool sendTo(size_t hint, const uint8_t* data, size_t len, const sockaddr_in& dst);
+
+private:
+    uint16_t localPort_;
+    int nSockets_;
+    std::vector<int> fds_;
+    std::vector<std::thread> threads_;
+    std::atomic<bool> running_{false};
+    RxHandler rx_;
+
+    int openSocket();
+    void rxLoop(int fd);
+};
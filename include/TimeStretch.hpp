@@ -0,0 +1,87 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// -------- Zaman ölçekleme (time-scale modification) --------
+// Decode edilmiş sesi perdeyi bozmadan biraz hızlı/yavaş çalar (WSOLA). Hız; jitter buffer
+// derinliği (hızlı döngü, spike sonrası kuyruğu eritir) ve uzun vadeli saat kayması tahmini
+// (yavaş döngü, gönderici capture ile yerel playout saatinin farkı) ile belirlenir. Hedef
+// derinlik sabit değil: akış sürerken buffer boşalırsa bir frame artar, temiz playout'ta
+// yavaşça azalır; böylece gecikme o anki jitter için güvenli en düşük seviyede kalır.
+struct TimeStretchParams {
+    bool   enabled     = true;
+    int    minTargetMs = 40;    // jitter buffer + stretch tamponu için hedef alt sınırı
+    int    maxTargetMs = 240;
+    double maxSpeedup  = 0.08;  // en fazla %8 hızlı (spike sonrası)
+    double maxSlowdown = 0.05;  // en fazla %5 yavaş (kuyruk boşalırken)
+    double maxDriftPpm = 5000;  // saat kayması tahmini sınırı
+};
+
+struct TimeStretchStats {
+    double rate = 1.0;       // son uygulanan hız (>1 hızlı)
+    double targetMs = 0;     // o anki hedef derinlik
+    double driftPpm = 0;     // uzun vadeli kayma tahmini
+    double depthMs = 0;      // filtrelenmiş alım kuyruğu
+    double netMs = 0;        // toplam kısaltılan (+) / uzatılan (-) süre
+};
+
+// WSOLA: çıkışı L örneklik adımlarla, O örnek çapraz geçişle kurar. Her adımda girişte
+// nominal konumun ±tol çevresinde, bir önceki segmentin doğal devamına en çok benzeyen
+// nokta seçilir. Doğal devam aralıktaysa o seçilir: rate==1'de çıkış girişle birebir aynıdır.
+class WsolaStretcher {
+public:
+    void configure(int sampleRate);
+    void reset();
+    void setRate(double rate) { rate_ = rate; }
+    void push(const int16_t* pcm, int n);
+    // En fazla n örnek kopyalar, kopyalananı döndürür.
+    int  pull(int16_t* out, int n);
+    int  available() const { return (int)(out_.size() - outRead_); }
+    // Çıkış adımı (L); çıkış bu granülde büyür.
+    int  hop() const { return L_; }
+    // Henüz çıkışa dönüşmemiş giriş (gecikme hesabı için).
+    int  pendingInput() const;
+    // Şimdiye kadar atlanan (+) / tekrarlanan (-) giriş, ms.
+    double scaledMs() const { return scaledMs_; }
+
+private:
+    int sampleRate_ = 16000;
+    int L_ = 240, O_ = 80, tol_ = 80;
+    double rate_ = 1.0;
+    std::atomic<double> scaledMs_{0};
+
+    std::vector<float> in_;     // inBase_ mutlak indeksinden başlar
+    long long inBase_ = 0;
+    double    nominal_ = 0;     // sıradaki segmentin nominal mutlak başlangıcı
+    long long prevPos_ = -1;    // son seçilen segment başı (mutlak); <0: ilk segment
+    std::vector<float> tail_;   // son segmentin çapraz geçiş bekleyen kuyruğu (O örnek)
+    std::vector<float> win_;    // çapraz geçiş penceresi (yükselen)
+    std::vector<int16_t> out_;
+    size_t outRead_ = 0;
+
+    bool step();
+    long long bestOffset(long long lo, long long hi) const;
+};
+
+// PI denetleyici: P terimi kuyruk fazlasını/eksiğini hızla kapatır, I terimi kalıcı saat
+// kaymasını öğrenir (drift). Her playout frame'inde bir kez çağrılır.
+class PlayoutRateController {
+public:
+    void configure(const TimeStretchParams& p, int frameMs);
+    // depthMs: jitter buffer + stretch tamponu; starving: çalınacak frame yok;
+    // active: akış sürüyor (son birkaç frame içinde paket geldi), yani boşalma bir takılma.
+    double update(double depthMs, bool starving, bool active);
+    TimeStretchStats stats() const;
+
+private:
+    TimeStretchParams p_;
+    int    frameMs_ = 20;
+    double filt_ = -1;
+    double drift_ = 0;
+    double target_ = 0;
+    bool   wasGlitch_ = false;
+
+    std::atomic<double> rate_{1.0}, driftPpm_{0}, depthMs_{0}, targetMs_{0};
+};
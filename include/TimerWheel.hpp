@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// -------- Hiyerarşik timer wheel --------
+// Seviye 0: 256 slot x 1 tick, seviye 1: 64 slot x 256 tick, ötesi overflow listesi.
+// Tick birimi çağırana aittir (SessionHost için 1 ms). Thread-safe değildir.
+class TimerWheel {
+public:
+    explicit TimerWheel(uint64_t startTick = 0) : cur_(startTick) {}
+
+    // expiryTick mutlak tick; geçmişte kalmışsa bir sonraki advance'te düşer.
+    // Kaydın gerçek süresini döndürür (cancel için saklanır).
+    uint64_t schedule(uint32_t id, uint64_t expiryTick);
+    // schedule'ın döndürdüğü süreyle; kayıt bu süre için tek bir slotta olabilir.
+    // Henüz düşmemişse siler ve true döner.
+    bool cancel(uint32_t id, uint64_t expiryTick);
+    // nowTick'e kadar ilerler, süresi dolan id'leri out'a ekler.
+    void advance(uint64_t nowTick, std::vector<uint32_t>& out);
+
+    uint64_t currentTick() const { return cur_; }
+    size_t   size() const { return count_; }
+
+private:
+    static constexpr uint64_t L0_BITS = 8,  L0_SIZE = 1u << L0_BITS;
+    static constexpr uint64_t L1_BITS = 6,  L1_SIZE = 1u << L1_BITS;
+
+    struct Entry { uint64_t expiry; uint32_t id; };
+
+    uint64_t cur_;
+    size_t count_ = 0;
+    std::vector<Entry> l0_[L0_SIZE];
+    std::vector<Entry> l1_[L1_SIZE];
+    std::vector<Entry> overflow_;
+    std::vector<Entry> scratch_;
+
+    void place(const Entry& e);
+    void cascade(std::vector<Entry>& slot, std::vector<uint32_t>& out);
+};
@@ -1,8 +1,11 @@
 #pragma once
 #include "VoiceEngine.hpp"
 #include <atomic>
+#include <mutex>
 #include <thread>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <sys/types.h>
 #include <sys/socket.h>
@@ -21,6 +24,23 @@ public:
 
     bool setRemote(const std::string& ip, uint16_t port);
 
+    // SO_TIMESTAMPNS: RX datagramları kernel varış zamanıyla damgalanır (start()'tan önce çağır).
+    void enableKernelTimestamps(bool on) { kernelTs_ = on; }
+    uint64_t lastRxTimestampNs() const override { return lastRxNs_; }
+
+    // ---- Multicast (IPv4, LAN segmenti)
+    // Gruba katıl/ayrıl; ifaceIp boşsa kernel seçer. start()'tan önce de çağrılabilir.
+    bool joinGroup(const std::string& group, const std::string& ifaceIp = "");
+    bool leaveGroup(const std::string& group, const std::string& ifaceIp = "");
+    // Bu convId'nin paketleri unicast remote yerine gruba gider (port 0: remote portu).
+    bool mapConvToGroup(uint32_t convId, const std::string& group, uint16_t port = 0);
+    void unmapConv(uint32_t convId);
+    void setMulticastTtl(int ttl);            // varsayılan 1: segment dışına çıkmaz
+    void setMulticastLoopback(bool on);       // aynı host'taki dinleyicilere de teslim
+    bool setMulticastInterface(const std::string& ifaceIp);
+    // Gruba katılınca aynı datagramın unicast + multicast kopyalarından biri düşürülür.
+    uint64_t duplicatesDropped() const { return dupDropped_; }
+
     ~UdpTransport() override { stop(); }
 private:
     int fd_ = -1;
@@ -30,7 +50,28 @@ private:
 
     ::sockaddr_in remote_{};
     uint16_t localPort_;
+    bool kernelTs_ = false;
+    uint64_t lastRxNs_ = 0; // sadece rx thread'i yazar/okur
+
+    // multicast ayarları; fd_ açılınca (veya açıksa hemen) uygulanır
+    struct Membership { ::in_addr group{}; ::in_addr iface{}; };
+    std::mutex mcMu_;
+    std::vector<Membership> groups_;
+    std::unordered_map<uint32_t, ::sockaddr_in> convGroups_;
+    std::atomic<bool> hasConvGroups_{false};
+    std::atomic<bool> dedup_{false};
+    int mcTtl_ = 1;
+    bool mcLoop_ = false;
+    ::in_addr mcIf_{};
+
+    // içerik özeti ile son görülen datagramlar (direct-mapped, sadece rx thread)
+    static constexpr size_t DEDUP_SLOTS = 1024;
+    std::vector<uint64_t> seen_ = std::vector<uint64_t>(DEDUP_SLOTS, 0);
+    std::atomic<uint64_t> dupDropped_{0};
 
     bool openSocket(uint16_t localPort);
+    bool applyMembership(const Membership& m, bool join);
+    void applyMulticastOptions();
+    bool isDuplicate(const uint8_t* data, size_t len);
     void rxLoop();
 };
@@ -1,14 +1,20 @@
 #pragma once
+#include <atomic>
 #include <cstdint>
 #include <cstddef>
 #include <vector>
 #include <functional>
+#include <memory>
 #include <queue>
 #include <mutex>
 #include <optional>
 #include <string>
 
-#include "NoiseSuppressorSpeex.hpp"
+#include "PreprocessChain.hpp"
+#include "FramePipeline.hpp"
+#include "ComplexityGovernor.hpp"
+#include "PlayoutScheduler.hpp"
+#include "TimeStretch.hpp"
 #include "RttProbe.hpp"
 #include "RttEchoServer.hpp"
 
@@ -26,12 +32,23 @@ struct MeshVoiceHeader {
 };
 #pragma pack(pop)
 
+// flags bitleri: bit0=PTT, bit1=FEC parity, bit2=FEC alıcı raporu (bkz. PacketFec.hpp).
+// Parity/rapor paketlerinde payLen=0 (gövde datagram uzunluğundan okunur): flag'leri
+// bilmeyen eski alıcılar payLen=0 paketi medya saymadan atar.
+enum : uint8_t { MVH_FLAG_PARITY = 0x02, MVH_FLAG_FEC_REPORT = 0x04 };
+
 // -------- Transport arayüzü --------
 class ITransport {
 public:
     using RxHandler = std::function<void(const uint8_t*, size_t)>;
     virtual bool send(const uint8_t* data, size_t len) = 0;
     virtual void onReceive(RxHandler h) = 0;
+    // Son alınan datagramın kernel zaman damgası (CLOCK_REALTIME ns), 0 = yok.
+    // Sadece RxHandler içinden çağrıldığında anlamlı.
+    virtual uint64_t lastRxTimestampNs() const { return 0; }
+    // Congestion controller'ın hedef gönderim hızı (bps, uygulama başlıkları dahil). Pacing
+    // katmanı kullanır; decorator'lar kendi ek yükünü ekleyip içeri iletir.
+    virtual void setSendRate(int bps) { (void)bps; }
     virtual ~ITransport() = default;
 };
 
@@ -43,29 +60,44 @@ struct VoiceParams {
     bool opusFec     = true;  // FEC hep açık
     bool opusDtx     = false; // debug için kapalı
     int expectedLoss = 10;
+    GovernorParams governor;  // encoder complexity / CPU bütçesi
+    PreprocParams preproc;    // HPF / NS / AGC / VAD zinciri
+    PlayoutParams playout;    // cihaz kuyruğu hedef gecikmesi
+    TimeStretchParams stretch; // decode sonrası WSOLA hız ayarı (jitter + saat kayması)
 };
 
 // -------- Audio I/O --------
+// Her instance kendi stream'lerini tutar; Pa_Initialize/Pa_Terminate süreç genelinde referans sayılır.
 class AudioIO {
 public:
-    bool startCapture(int sampleRate, int channels);
+    bool startCapture(int sampleRate, int channels, int frameMs = 20);
     bool startPlayback(int sampleRate, int channels);
     bool readFrame(std::vector<int16_t>& outPcm);
+    bool readFrame(int16_t* out, int samples);
     bool writeFrame(const std::vector<int16_t>& pcm);
+    bool writeFrame(const int16_t* pcm, size_t samples);
+    // Çıkış kuyruğunda bloklamadan yazılabilecek örnek sayısı; stream yoksa -1.
+    long writeAvailable() const;
+    // Çıkış tamponunun kapasitesi: Pa_StartStream'den hemen sonra, boşken ölçülür; bilinmiyorsa 0.
+    long outputCapacity() const { return outCapacity_; }
     void stop();
     int  frameSamples(int sampleRate, int frameMs) const {
         return sampleRate * frameMs / 1000;
     }
     void setPreferredDevices(int inIndex, int outIndex);
-};
-
-// -------- Basit VAD --------
-class SimpleVAD {
-public:
-    void configure(float thRms = 300.0f, int hangMs = 150);
-    bool isSpeech(const int16_t* pcm, int n, int sampleRate);
+    ~AudioIO() { stop(); }
 private:
-    int hangSamples_ = 0, remain_ = 0; float thr_=300.f;
+    void* in_  = nullptr;   // PaStream*
+    void* out_ = nullptr;   // PaStream*
+    bool paRef_ = false;
+    int sampleRate_ = 16000;
+    int channels_ = 1;
+    int frameSamples_ = 320; // 20ms @16k
+    long outCapacity_ = 0;
+    int inIndex_ = -1;
+    int outIndex_ = -1;
+    uint16_t capFrames_ = 0, playFrames_ = 0; // olay izi için cihaz frame sayaçları
+    bool acquirePa();
 };
 
 // -------- Opus codec --------
@@ -76,6 +108,10 @@ public:
     size_t encode(const int16_t* pcm, int samples, uint8_t* out, size_t outMax);
     size_t decode(const uint8_t* in, size_t inLen, int16_t* pcmOut, size_t maxSamples);
     void  reconfigure(int bitrateBps, int fec, int lossPerc);
+    void  setComplexity(int complexity);
+    void  setMaxBandwidth(int bwLevel); // BW_NARROW..BW_FULL
+    // Encoder gecikmesi (OPUS_GET_LOOKAHEAD), encoder örnek hızında; encoder yoksa -1.
+    int   lookahead() const;
     ~OpusCodec();
 private:
     struct OpusEncoder* enc_ = nullptr;
@@ -93,6 +129,8 @@ public:
     explicit JitterBuffer(uint16_t targetFrames = 3);
     void push(uint16_t seq, std::vector<uint8_t> frame);
     std::optional<EncodedFrame> popReady();
+    // Baştan kesintisiz çalınabilecek frame sayısı (eksik seq'in arkasındakiler sayılmaz).
+    size_t readyFrames();
 private:
     uint16_t target_;
     uint16_t baseSeq_{0};
@@ -106,12 +144,28 @@ class VoiceEngine {
 public:
     void setDevices(int inIndex, int outIndex);
     bool init(const VoiceParams& vp, ITransport* tr, uint32_t convId);
+    // Ses cihazı olmadan tam pipeline (NS/VAD/codec/jitter); PCM'i çağıran sağlar/tüketir.
+    // SessionHost gibi çok oturumlu süreçler için.
+    bool initHeadless(const VoiceParams& vp, ITransport* tr, uint32_t convId);
+    // Sadece alım yolu (jitter buffer + decoder), ses cihazı açmaz. Replay için.
+    bool initReceiver(const VoiceParams& vp);
     void setPtt(bool down);
     void setLocalEcho(bool on) { localEcho_ = on; }
     void setBypassVad(bool on) { bypassVad_ = on; }
     void pollOnce();
     void shutdown();
 
+    // Alım yolu: gelen datagram -> jitter buffer; bir frame'lik playout üretir.
+    // playoutFrame decode edilmiş frame için true, sessizlik (concealment) için false döner.
+    void ingest(const uint8_t* data, size_t len) { onRx(data, len); }
+    bool playoutFrame(std::vector<int16_t>& outPcm);
+    // samples: giriş kapasite, çıkış üretilen örnek sayısı.
+    bool playoutFrame(int16_t* out, int& samples);
+    // Gönderim yolu: capture frame'i yerinde NS'den geçirir, konuşmaysa encode edip gönderir.
+    void sendFrame(std::vector<int16_t>& pcm);
+    void sendFrame(int16_t* pcm, int n);
+    int  frameSamples() const { return audio_.frameSamples(vp_.sampleRate, vp_.frameMs); }
+
     void enableEchoServer(uint16_t port){ runEcho_=true; echoPort_=port; }
     void enableRttProbe(const std::string& remoteIp, uint16_t remoteEchoPort,
                         const std::string& localIp="0.0.0.0", uint16_t localPort=0);
@@ -119,6 +173,14 @@ public:
     uint64_t txFrames() const { return txFrames_; }
     uint64_t rxFrames() const { return rxFrames_; }
     double   rttMs()    const { return rttProbe_ ? rttProbe_->rttMs() : -1.0; }
+    GovernorStats governorStats() const { return gov_.stats(); }
+    std::vector<PreprocessChain::StageTiming> preprocessTimings() const { return pre_.timings(); }
+    PlayoutStats playoutStats() const { return playout_.stats(); }
+    TimeStretchStats stretchStats() const {
+        TimeStretchStats st = rateCtl_.stats();
+        st.netMs = tsm_.scaledMs();
+        return st;
+    }
 
 private:
     VoiceParams vp_;
@@ -127,16 +189,26 @@ private:
     uint16_t seq_ = 0;
 
     AudioIO audio_;
-    SimpleVAD vad_;
     OpusCodec codec_;
     JitterBuffer jb_{3};
-    NoiseSuppressorSpeex ns_;
+    PreprocessChain pre_;
+    FramePipeline pipe_;
+    ComplexityGovernor gov_;
+    PlayoutScheduler playout_;
+    WsolaStretcher tsm_;
+    PlayoutRateController rateCtl_;
+    std::vector<int16_t> decodeBuf_;
+    bool lastDecoded_ = false;
+    std::atomic<uint64_t> rxPackets_{0};   // onRx (rx thread)
+    uint64_t seenRxPackets_ = 0;           // playout thread
+    int framesSinceRx_ = 1 << 20;
 
     bool localEcho_ = false;
     bool bypassVad_ = false;
 
-    uint64_t txFrames_ = 0;
-    uint64_t rxFrames_ = 0;
+    std::atomic<uint64_t> txFrames_{0};
+    std::atomic<uint64_t> rxFrames_{0};
+    uint32_t lastAdapt_ = 0;
 
     // RTT / Echo
     RttProbe* rttProbe_ = nullptr;
@@ -144,5 +216,11 @@ private:
     bool runEcho_ = false;
     uint16_t echoPort_ = 7002;
 
+    bool initPipeline();
+    void initStretch();
+    template<class Pipe> void pollFrame(Pipe& p);
+    bool decodeNext(int16_t* out, int& samples);
     void onRx(const uint8_t* data, size_t len);
+    void adaptBitrate(uint32_t now);
+    void announceRate(int codecBps);
 };
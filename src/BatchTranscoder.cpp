@@ -0,0 +1,372 @@
+#include "BatchTranscoder.hpp"
+#include <opus/opus.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+uint16_t rd16(const uint8_t* p){ uint16_t v; std::memcpy(&v, p, 2); return v; }
+uint32_t rd32(const uint8_t* p){ uint32_t v; std::memcpy(&v, p, 4); return v; }
+
+// Ogg CRC-32: polinom 0x04c11db7, yansıtmasız, başlangıç 0
+const std::array<uint32_t, 256> kOggCrc = []{
+    std::array<uint32_t, 256> t{};
+    for (uint32_t i=0;i<256;++i) {
+        uint32_t r = i << 24;
+        for (int k=0;k<8;++k) r = (r & 0x80000000u) ? (r << 1) ^ 0x04c11db7u : (r << 1);
+        t[i] = r;
+    }
+    return t;
+}();
+
+uint32_t oggCrc(uint32_t crc, const uint8_t* p, size_t n){
+    for (size_t i=0;i<n;++i) crc = (crc << 8) ^ kOggCrc[((crc >> 24) ^ p[i]) & 0xff];
+    return crc;
+}
+
+bool opusRate(int sr){ return sr == 8000 || sr == 12000 || sr == 16000 || sr == 24000 || sr == 48000; }
+
+// Parçaları encode edecek encoder'ın gecikmesi, 48 kHz örnek (Ogg pre-skip); hata: -1.
+int encoderDelay48k(const VoiceParams& vp, int sampleRate){
+    OpusCodec c;
+    if (!c.initEnc(sampleRate, vp.bitrateBps, /*fec*/true, vp.opusDtx, vp.expectedLoss)) return -1;
+    const int la = c.lookahead();
+    return la < 0 ? -1 : (int)((int64_t)la * 48000 / sampleRate);
+}
+
+// VoiceEngine'in gönderdiği paketlerden Opus payload'unu toplar.
+struct PacketSink : ITransport {
+    std::vector<std::vector<uint8_t>>* out = nullptr;
+    bool keep = false;
+    bool send(const uint8_t* data, size_t len) override {
+        if (keep && out && len >= sizeof(MeshVoiceHeader))
+            out->emplace_back(data + sizeof(MeshVoiceHeader), data + len);
+        return true;
+    }
+    void onReceive(RxHandler) override {}
+};
+}
+
+// ---------- WavFile ----------
+bool WavFile::open(const std::string& path, std::string& err){
+    close();
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) { err = "cannot open"; return false; }
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || st.st_size < 12) { ::close(fd); err = "not a WAV file"; return false; }
+    mapLen_ = (size_t)st.st_size;
+    map_ = ::mmap(nullptr, mapLen_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);   // eşleme fd'den bağımsız yaşar
+    if (map_ == MAP_FAILED) { map_ = nullptr; err = "mmap failed"; return false; }
+    ::madvise(map_, mapLen_, MADV_SEQUENTIAL);
+
+    const uint8_t* p = (const uint8_t*)map_;
+    if (std::memcmp(p, "RIFF", 4) != 0 || std::memcmp(p + 8, "WAVE", 4) != 0) {
+        close(); err = "not a WAV file"; return false;
+    }
+    int format = 0, bits = 0;
+    size_t off = 12;
+    while (off + 8 <= mapLen_) {
+        const uint32_t size = rd32(p + off + 4);
+        const uint8_t* body = p + off + 8;
+        const size_t avail = mapLen_ - off - 8;
+        if (std::memcmp(p + off, "fmt ", 4) == 0 && avail >= 16) {
+            format = rd16(body);
+            channels_ = rd16(body + 2);
+            sampleRate_ = (int)rd32(body + 4);
+            bits = rd16(body + 14);
+            if (format == 0xFFFE && size >= 26 && avail >= 26) format = rd16(body + 24); // WAVE_FORMAT_EXTENSIBLE alt formatı
+        } else if (std::memcmp(p + off, "data", 4) == 0) {
+            data_ = body;
+            const size_t bytes = std::min<size_t>(size, avail);
+            samples_ = channels_ > 0 ? (long long)(bytes / (2u * (size_t)channels_)) : 0;
+            break;
+        }
+        off += 8 + (size_t)size + (size & 1);
+    }
+    if (!data_ || format != 1 || bits != 16 || channels_ < 1) {
+        close(); err = "unsupported WAV (PCM 16-bit expected)"; return false;
+    }
+    return true;
+}
+
+void WavFile::close(){
+    if (map_) ::munmap(map_, mapLen_);
+    map_ = nullptr; mapLen_ = 0; data_ = nullptr;
+    sampleRate_ = channels_ = 0; samples_ = 0;
+}
+
+void WavFile::read(long long pos, int16_t* out, int n) const {
+    const long long have = std::clamp(samples_ - pos, 0LL, (long long)n);
+    if (channels_ == 1) {
+        if (have > 0) std::memcpy(out, data_ + pos * 2, (size_t)have * 2);
+    } else if (have > 0) {
+        const uint8_t* src = data_ + pos * 2 * channels_;
+        for (long long i=0;i<have;++i) {
+            int sum = 0;
+            for (int c=0;c<channels_;++c) sum += (int16_t)rd16(src + (i * channels_ + c) * 2);
+            out[i] = (int16_t)(sum / channels_);
+        }
+    }
+    std::fill(out + std::max(0LL, have), out + n, (int16_t)0);
+}
+
+// ---------- OggOpusWriter ----------
+bool OggOpusWriter::open(const std::string& path, int inputRate, uint32_t serial, int preSkip48k){
+    f_ = std::fopen(path.c_str(), "wb");
+    if (!f_) return false;
+    serial_ = serial; pageSeq_ = 0; granule_ = 0; ok_ = true;
+    preSkip_ = std::clamp(preSkip48k, 0, 0xFFFF);
+
+    // OpusHead: sürüm 1, mono, pre-skip, kaynak örnekleme hızı, kazanç 0, mapping 0
+    body_.assign({ 'O','p','u','s','H','e','a','d', 1, 1 });
+    body_.push_back((uint8_t)(preSkip_ & 0xff)); body_.push_back((uint8_t)(preSkip_ >> 8));
+    for (int i=0;i<4;++i) body_.push_back((uint8_t)((uint32_t)inputRate >> (8 * i)));
+    body_.insert(body_.end(), { 0, 0, 0 });
+    lacing_.assign(1, (uint8_t)body_.size());
+    if (!flushPage(0x02, 0)) return false;
+
+    // OpusTags: vendor = libopus sürümü, yorum yok
+    const char* vendor = opus_get_version_string();
+    const uint32_t vlen = (uint32_t)std::strlen(vendor);
+    body_.assign({ 'O','p','u','s','T','a','g','s' });
+    for (int i=0;i<4;++i) body_.push_back((uint8_t)(vlen >> (8 * i)));
+    body_.insert(body_.end(), vendor, vendor + vlen);
+    body_.insert(body_.end(), { 0, 0, 0, 0 });
+    lacing_.assign(body_.size() / 255, 255);
+    lacing_.push_back((uint8_t)(body_.size() % 255));
+    return flushPage(0, 0);
+}
+
+bool OggOpusWriter::writePacket(const uint8_t* pkt, size_t len, int samples48k){
+    const size_t segs = len / 255 + 1;
+    // Sayfa ~1 s dolunca (ya da lacing tablosu taşacaksa) kapat; son sayfa close()'a kalır
+    if (pagePackets_ && (pageSamples_ >= 48000 || lacing_.size() + segs > 255))
+        flushPage(0, granule_);
+    lacing_.insert(lacing_.end(), len / 255, 255);
+    lacing_.push_back((uint8_t)(len % 255));
+    body_.insert(body_.end(), pkt, pkt + len);
+    granule_ += samples48k;
+    pagePackets_++; pageSamples_ += samples48k;
+    return ok_;
+}
+
+bool OggOpusWriter::close(int64_t totalSamples48k){
+    if (!f_) return false;
+    // Son sayfanın granule'ü gerçek uzunluğa kırpılır (RFC 7845 §4.5)
+    flushPage(0x04, std::min(granule_, (int64_t)preSkip_ + totalSamples48k));
+    const bool ok = std::fclose(f_) == 0 && ok_;
+    f_ = nullptr;
+    return ok;
+}
+
+bool OggOpusWriter::flushPage(uint8_t flags, int64_t granule){
+    uint8_t hdr[27] = { 'O','g','g','S', 0, flags };
+    for (int i=0;i<8;++i) hdr[6 + i]  = (uint8_t)((uint64_t)granule >> (8 * i));
+    for (int i=0;i<4;++i) hdr[14 + i] = (uint8_t)(serial_ >> (8 * i));
+    for (int i=0;i<4;++i) hdr[18 + i] = (uint8_t)(pageSeq_ >> (8 * i));
+    hdr[26] = (uint8_t)lacing_.size();
+    uint32_t crc = oggCrc(0, hdr, sizeof(hdr));
+    crc = oggCrc(crc, lacing_.data(), lacing_.size());
+    crc = oggCrc(crc, body_.data(), body_.size());
+    for (int i=0;i<4;++i) hdr[22 + i] = (uint8_t)(crc >> (8 * i));
+
+    ok_ = ok_ && std::fwrite(hdr, 1, sizeof(hdr), f_) == sizeof(hdr)
+              && std::fwrite(lacing_.data(), 1, lacing_.size(), f_) == lacing_.size()
+              && std::fwrite(body_.data(), 1, body_.size(), f_) == body_.size();
+    pageSeq_++;
+    body_.clear(); lacing_.clear();
+    pagePackets_ = 0; pageSamples_ = 0;
+    return ok_;
+}
+
+// ---------- BatchTranscoder ----------
+std::string BatchTranscoder::outputPath(const std::string& input, const std::string& outDir,
+                                        TranscodeParams::Format fmt){
+    const size_t slash = input.find_last_of('/');
+    std::string base = slash == std::string::npos ? input : input.substr(slash + 1);
+    const size_t dot = base.find_last_of('.');
+    if (dot != std::string::npos && dot > 0) base.resize(dot);
+    const std::string dir = !outDir.empty() ? outDir
+                          : slash == std::string::npos ? std::string(".") : input.substr(0, slash);
+    return dir + "/" + base + (fmt == TranscodeParams::RAW ? ".lmop" : ".opus");
+}
+
+bool BatchTranscoder::encodeChunk(const WavFile& wav, long long firstFrame, long long endFrame,
+                                  std::vector<std::vector<uint8_t>>& out, std::string& err) const {
+    // Canlı gönderim yolu; VAD yok, complexity sabit (governor min=max)
+    VoiceParams vp = tp_.voice;
+    vp.sampleRate = wav.sampleRate();
+    vp.preproc.vad = false;
+    const int cx = std::clamp(tp_.complexity, 0, 10);
+    vp.governor.enabled = true;
+    vp.governor.adaptBandwidth = false;
+    vp.governor.minComplexity = vp.governor.maxComplexity = vp.governor.startComplexity = cx;
+
+    PacketSink sink;
+    VoiceEngine ve;
+    ve.setBypassVad(true);
+    if (!ve.initHeadless(vp, &sink, 0)) { err = "encoder init failed"; return false; }
+
+    const int n = ve.frameSamples();
+    const long long warm = std::llround(std::max(0.0, tp_.overlapSec) * 1000.0 / vp.frameMs);
+    std::vector<int16_t> pcm((size_t)n);
+    out.clear();
+    out.reserve((size_t)(endFrame - firstFrame));
+    sink.out = &out;
+
+    for (long long f = std::max(0LL, firstFrame - warm); f < endFrame; ++f) {
+        wav.read(f * n, pcm.data(), n);
+        sink.keep = f >= firstFrame;
+        const size_t before = out.size();
+        ve.sendFrame(pcm.data(), n);
+        if (sink.keep && out.size() != before + 1) {
+            err = "encode failed at frame " + std::to_string(f);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BatchTranscoder::writeOutput(const WavFile& wav, const std::vector<std::vector<std::vector<uint8_t>>>& chunks,
+                                  int preSkip48k, TranscodeResult& res) const {
+    const int frameMs = tp_.voice.frameMs;
+    uint64_t count = 0;
+    for (const auto& c : chunks) count += c.size();
+
+    if (tp_.format == TranscodeParams::OGG) {
+        uint32_t serial = 2166136261u;   // çıktı yolunun FNV-1a özeti: tekrarlanabilir
+        for (unsigned char ch : res.output) serial = (serial ^ ch) * 16777619u;
+        OggOpusWriter w;
+        if (!w.open(res.output, wav.sampleRate(), serial, preSkip48k)) { res.error = "cannot write " + res.output; return false; }
+        for (const auto& c : chunks)
+            for (const auto& p : c) { w.writePacket(p.data(), p.size(), frameMs * 48); res.bytes += p.size(); }
+        if (!w.close(wav.samples() * 48000 / wav.sampleRate())) { res.error = "write failed"; return false; }
+    } else {
+        std::FILE* f = std::fopen(res.output.c_str(), "wb");
+        if (!f) { res.error = "cannot write " + res.output; return false; }
+        const uint16_t ver = 1, fms = (uint16_t)frameMs;
+        const uint32_t sr = (uint32_t)wav.sampleRate(), cnt = (uint32_t)count;
+        bool ok = std::fwrite("LMOP", 1, 4, f) == 4 && std::fwrite(&ver, 2, 1, f) == 1
+               && std::fwrite(&fms, 2, 1, f) == 1 && std::fwrite(&sr, 4, 1, f) == 1
+               && std::fwrite(&cnt, 4, 1, f) == 1;
+        for (const auto& c : chunks) {
+            for (const auto& p : c) {
+                const uint16_t len = (uint16_t)p.size();
+                ok = ok && std::fwrite(&len, 2, 1, f) == 1 && std::fwrite(p.data(), 1, p.size(), f) == p.size();
+                res.bytes += p.size();
+            }
+        }
+        ok = std::fclose(f) == 0 && ok;
+        if (!ok) { res.error = "write failed"; return false; }
+    }
+    res.packets = count;
+    return true;
+}
+
+std::vector<TranscodeResult> BatchTranscoder::run(const std::vector<std::string>& inputs, const std::string& outDir,
+                                                  std::function<void(const TranscodeResult&)> onDone){
+    struct FileState {
+        WavFile wav;
+        std::vector<std::vector<std::vector<uint8_t>>> chunks;
+        std::atomic<int> remaining{0};
+        std::mutex m;
+        bool failed = false;
+        std::string err;
+        double cpuSec = 0;
+        int preSkip48k = 0;
+    };
+    struct Job { size_t file; int index; long long first, end; };
+
+    std::vector<TranscodeResult> results(inputs.size());
+    std::vector<std::unique_ptr<FileState>> files;
+    std::vector<Job> jobs;
+    std::mutex doneMu;
+
+    const int frameMs = std::max(1, tp_.voice.frameMs);
+    for (size_t i=0;i<inputs.size();++i) {
+        TranscodeResult& r = results[i];
+        r.input = inputs[i];
+        r.output = outputPath(inputs[i], outDir, tp_.format);
+        files.push_back(std::make_unique<FileState>());
+        FileState& fs = *files.back();
+
+        std::string err;
+        if (!fs.wav.open(inputs[i], err)) r.error = err;
+        else if (!opusRate(fs.wav.sampleRate()))
+            r.error = "unsupported sample rate " + std::to_string(fs.wav.sampleRate()) + " (Opus: 8/12/16/24/48 kHz)";
+        else if ((fs.preSkip48k = encoderDelay48k(tp_.voice, fs.wav.sampleRate())) < 0)
+            r.error = "encoder init failed";
+        if (!r.error.empty()) { if (onDone) onDone(r); continue; }
+
+        // Encoder gecikmesi kadar fazladan (sıfır) encode edilir: kaynağın sonu da çalınır
+        const long long n = (long long)fs.wav.sampleRate() * frameMs / 1000;
+        const long long total = fs.wav.samples() + ((long long)fs.preSkip48k * fs.wav.sampleRate() + 47999) / 48000;
+        const long long frames = std::max(1LL, (total + n - 1) / n);
+        const long long per = tp_.chunkSec > 0
+                            ? std::max(1LL, std::llround(tp_.chunkSec * 1000.0 / frameMs)) : frames;
+        const int nChunks = (int)((frames + per - 1) / per);
+
+        r.audioSec = fs.wav.seconds();
+        r.chunks = nChunks;
+        fs.chunks.resize((size_t)nChunks);
+        fs.remaining = nChunks;
+        for (int c=0;c<nChunks;++c)
+            jobs.push_back({ i, c, c * per, std::min(frames, (c + 1) * per) });
+    }
+
+    // Uzun işler önce: son çekirdekler boşta beklemez
+    std::stable_sort(jobs.begin(), jobs.end(),
+                     [](const Job& a, const Job& b){ return a.end - a.first > b.end - b.first; });
+
+    std::atomic<size_t> next{0};
+    auto worker = [&]{
+        for (size_t j; (j = next.fetch_add(1)) < jobs.size();) {
+            const Job& job = jobs[j];
+            FileState& fs = *files[job.file];
+            bool skip;
+            { std::lock_guard<std::mutex> lk(fs.m); skip = fs.failed; }
+            if (!skip) {
+                const auto t0 = std::chrono::steady_clock::now();
+                std::string err;
+                const bool ok = encodeChunk(fs.wav, job.first, job.end, fs.chunks[(size_t)job.index], err);
+                const double dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+                std::lock_guard<std::mutex> lk(fs.m);
+                fs.cpuSec += dt;
+                if (!ok && !fs.failed) { fs.failed = true; fs.err = err; }
+            }
+            // Dosyanın son parçasını bitiren yazar
+            if (fs.remaining.fetch_sub(1) != 1) continue;
+            TranscodeResult& r = results[job.file];
+            {
+                std::lock_guard<std::mutex> lk(fs.m);
+                r.cpuSec = fs.cpuSec;
+                if (fs.failed) r.error = fs.err;
+            }
+            if (r.error.empty()) r.ok = writeOutput(fs.wav, fs.chunks, fs.preSkip48k, r);
+            fs.chunks.clear();
+            fs.chunks.shrink_to_fit();
+            fs.wav.close();
+            if (onDone) { std::lock_guard<std::mutex> lk(doneMu); onDone(r); }
+        }
+    };
+
+    int nThreads = tp_.threads > 0 ? tp_.threads : (int)std::thread::hardware_concurrency();
+    nThreads = std::max(1, std::min(nThreads, (int)jobs.size()));
+    std::vector<std::thread> pool;
+    for (int t=1;t<nThreads;++t) pool.emplace_back(worker);
+    worker();
+    for (auto& t : pool) t.join();
+    return results;
+}
@@ -0,0 +1,127 @@
+#include "ComplexityGovernor.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+int ComplexityGovernor::nativeBandwidth(int sampleRate){
+    if (sampleRate <= 8000)  return BW_NARROW;
+    if (sampleRate <= 12000) return BW_MEDIUM;
+    if (sampleRate <= 16000) return BW_WIDE;
+    if (sampleRate <= 24000) return BW_SUPERWIDE;
+    return BW_FULL;
+}
+
+void ComplexityGovernor::configure(const GovernorParams& gp, int frameMs, int sampleRate){
+    std::lock_guard<std::mutex> lk(m_);
+    gp_ = gp;
+    gp_.minComplexity = std::clamp(gp.minComplexity, 0, 10);
+    gp_.maxComplexity = std::clamp(gp.maxComplexity, 0, 10);
+    if (gp_.minComplexity > gp_.maxComplexity) std::swap(gp_.minComplexity, gp_.maxComplexity);
+    gp_.windowFrames = std::max(1, gp.windowFrames);
+    gp_.upHoldWindows = std::max(1, gp.upHoldWindows);
+    budgetUs_ = gp.budgetUs > 0 ? gp.budgetUs : gp.budgetFrac * frameMs * 1000.0;
+    complexity_ = std::clamp(gp.startComplexity, gp_.minComplexity, gp_.maxComplexity);
+    // Doğal bandın üstü encoder'da zaten yok; tavan oradan başlamazsa ilk adımlar boşa gider.
+    maxBandwidth_ = nativeBandwidth(sampleRate);
+    bandwidth_ = maxBandwidth_;
+    frames_ = 0; encSum_ = decSum_ = peak_ = curFrame_ = 0; decFrames_ = 0; calmWindows_ = 0;
+    st_ = GovernorStats{};
+    st_.complexity = complexity_; st_.bandwidth = bandwidth_; st_.budgetUs = budgetUs_;
+}
+
+void ComplexityGovernor::onEncode(double us){
+    encSum_ += us;
+    frames_++;
+    peak_ = std::max(peak_, us + curFrame_);
+    curFrame_ = 0;
+}
+
+void ComplexityGovernor::onSilentFrame(){
+    peak_ = std::max(peak_, curFrame_);
+    curFrame_ = 0;
+}
+
+void ComplexityGovernor::onDecode(double us){
+    decSum_ += us;
+    decFrames_++;
+    // Stretch hızlanırken frame başına birden çok decode: hepsi bir sonraki encode'un frame'ine
+    curFrame_ += us;
+}
+
+bool ComplexityGovernor::update(int& complexity, int& bandwidth){
+    if (!gp_.enabled || frames_ < gp_.windowFrames) return false;
+
+    const double enc = encSum_ / frames_;
+    const double dec = decFrames_ ? decSum_ / decFrames_ : 0.0;
+    const double cost = enc + dec;
+    const double peak = peak_;
+    const double cpu = hostCpuBusy();
+    frames_ = 0; encSum_ = decSum_ = peak_ = 0; decFrames_ = 0;
+
+    // Histerezis: bütçe aşılınca hemen in, artırmak için art arda birkaç rahat pencere bekle.
+    const bool over = cost > budgetUs_ || peak > 3.0 * budgetUs_ || cpu > 0.90;
+    const bool calm = cost < 0.5 * budgetUs_ && peak < budgetUs_ && cpu < 0.70;
+    bool changed = false;
+    if (over) {
+        calmWindows_ = 0;
+        if (complexity_ > gp_.minComplexity) {
+            int step = cost > 2.0 * budgetUs_ ? 2 : 1;
+            complexity_ = std::max(gp_.minComplexity, complexity_ - step);
+            changed = true;
+        } else if (gp_.adaptBandwidth && bandwidth_ > BW_NARROW) {
+            bandwidth_--; changed = true;
+        }
+    } else if (calm) {
+        if (++calmWindows_ >= gp_.upHoldWindows) {
+            calmWindows_ = 0;
+            if (gp_.adaptBandwidth && bandwidth_ < maxBandwidth_) { bandwidth_++; changed = true; }
+            else if (complexity_ < gp_.maxComplexity) { complexity_++; changed = true; }
+        }
+    } else {
+        calmWindows_ = 0;
+    }
+
+    std::lock_guard<std::mutex> lk(m_);
+    st_.encodeUs = enc; st_.decodeUs = dec; st_.peakUs = peak; st_.cpuBusy = cpu;
+    st_.complexity = complexity_; st_.bandwidth = bandwidth_;
+    if (changed) st_.changes++;
+    complexity = complexity_;
+    bandwidth = bandwidth_;
+    return changed;
+}
+
+GovernorStats ComplexityGovernor::stats() const {
+    std::lock_guard<std::mutex> lk(m_);
+    return st_;
+}
+
+double ComplexityGovernor::hostCpuBusy(){
+#if defined(__linux__)
+    static std::mutex mu;
+    static std::chrono::steady_clock::time_point last;
+    static unsigned long long prevIdle = 0, prevTotal = 0;
+    static double busy = -1.0;
+
+    std::lock_guard<std::mutex> lk(mu);
+    auto now = std::chrono::steady_clock::now();
+    if (prevTotal != 0 && now - last < std::chrono::milliseconds(500)) return busy;
+    last = now;
+
+    std::FILE* f = std::fopen("/proc/stat", "r");
+    if (!f) return busy;
+    unsigned long long v[8] = {0};
+    int n = std::fscanf(f, "cpu %llu %llu %llu %llu %llu %llu %llu %llu",
+                        &v[0],&v[1],&v[2],&v[3],&v[4],&v[5],&v[6],&v[7]);
+    std::fclose(f);
+    if (n < 4) return busy;
+    unsigned long long idle = v[3] + v[4]; // idle + iowait
+    unsigned long long total = 0;
+    for (auto x : v) total += x;
+    if (prevTotal != 0 && total > prevTotal)
+        busy = 1.0 - double(idle - prevIdle) / double(total - prevTotal);
+    prevIdle = idle; prevTotal = total;
+    return busy;
+#else
+    return -1.0;
+#endif
+}
@@ -0,0 +1,184 @@
+#include "EventTrace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+// ---------- halka ----------
+// Slot başına seqlock: yazar önce damgayı geçersiz kılar, veriyi yazar, sonra damgayı
+// (index+1) yayınlar. Okuyucu damgayı veriden önce ve sonra okur; ikisi beklenen
+// index'e eşit değilse slot o sırada ezilmiştir ve atlanır. Yazar hiç beklemez.
+struct EventTracer::Ring {
+    struct Slot {
+        std::atomic<uint64_t> stamp{0};
+        std::atomic<uint64_t> ts{0};
+        std::atomic<uint64_t> a{0};    // dur(32) | seq(16) | ev(8)
+        std::atomic<uint64_t> b{0};    // tid(32) | arg(32)
+    };
+    explicit Ring(size_t n) : size(n), mask(n - 1), slots(new Slot[n]) {}
+    const size_t size, mask;
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<uint64_t> head{0};     // sadece sahibi yazar
+    std::atomic<bool> inUse{true};
+};
+
+// Thread bitince halkası serbest kalır (olaylar dump'a kadar durur), yeni thread devralır.
+struct EventTracer::ThreadSlot {
+    uint32_t tid = 0;
+    Ring* ring = nullptr;
+    ~ThreadSlot() { if (ring) ring->inUse.store(false, std::memory_order_release); }
+};
+
+std::atomic<bool> EventTracer::enabled_{false};
+
+EventTracer& EventTracer::instance(){
+    static EventTracer t;
+    return t;
+}
+
+uint64_t EventTracer::nowNs(){
+    using namespace std::chrono;
+    return (uint64_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+EventTracer::ThreadSlot& EventTracer::threadSlot(){
+    thread_local ThreadSlot ts;
+    if (!ts.tid) ts.tid = instance().nextTid_.fetch_add(1, std::memory_order_relaxed);
+    return ts;
+}
+
+void EventTracer::enable(bool on, size_t ringEvents){
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        size_t n = 256;
+        while (n < ringEvents) n <<= 1;
+        ringEvents_ = n;
+        if (!originNs_) originNs_ = nowNs();
+    }
+    enabled_.store(on, std::memory_order_relaxed);
+}
+
+void EventTracer::setThreadName(const std::string& name){
+    const uint32_t tid = threadSlot().tid;
+    std::lock_guard<std::mutex> lk(m_);
+    names_[tid] = name;
+}
+
+EventTracer::Ring* EventTracer::threadRing(){
+    ThreadSlot& ts = threadSlot();
+    if (ts.ring) return ts.ring;
+
+    std::lock_guard<std::mutex> lk(m_);
+    for (auto& r : rings_) {
+        bool expected = false;
+        if (r->size == ringEvents_ && r->inUse.compare_exchange_strong(expected, true)) {
+            ts.ring = r.get();
+            return ts.ring;
+        }
+    }
+    rings_.push_back(std::make_unique<Ring>(ringEvents_));
+    ts.ring = rings_.back().get();
+    return ts.ring;
+}
+
+void EventTracer::record(TraceEv ev, uint16_t seq, uint64_t startNs, uint64_t durNs, uint32_t arg){
+    if (!enabled()) return;
+    ThreadSlot& ts = threadSlot();
+    Ring* r = ts.ring ? ts.ring : threadRing();
+    const uint32_t tid = ts.tid;
+
+    const uint64_t i = r->head.load(std::memory_order_relaxed);
+    Ring::Slot& s = r->slots[i & r->mask];
+    s.stamp.store(~0ull, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    s.ts.store(startNs, std::memory_order_relaxed);
+    s.a.store((std::min<uint64_t>(durNs, 0xffffffffu) << 32) | (uint64_t(seq) << 16) | uint64_t(ev),
+              std::memory_order_relaxed);
+    s.b.store((uint64_t(tid) << 32) | arg, std::memory_order_relaxed);
+    s.stamp.store(i + 1, std::memory_order_release);
+    r->head.store(i + 1, std::memory_order_release);
+}
+
+// ---------- Chrome trace JSON ----------
+namespace {
+struct EvInfo { const char* name; const char* cat; const char* seqKey; const char* argKey; };
+const EvInfo kEvInfo[(int)TraceEv::COUNT] = {
+    { "capture", "audio", "frame", "samples" },
+    { "preproc", "tx",    "seq",   "speech"  },
+    { "encode",  "tx",    "seq",   "bytes"   },
+    { "send",    "net",   "seq",   "bytes"   },
+    { "recv",    "net",   "seq",   "bytes"   },
+    { "jb_push", "rx",    "seq",   "slot"    },
+    { "jb_pop",  "rx",    "seq",   nullptr   },
+    { "conceal", "rx",    nullptr, nullptr   },
+    { "decode",  "rx",    "seq",   "samples" },
+    { "play",    "audio", "frame", "samples" },
+};
+
+struct Decoded { uint64_t ts, dur; uint32_t tid, arg; uint16_t seq; uint8_t ev; };
+
+void writeEscaped(std::FILE* f, const std::string& s){
+    for (char c : s) {
+        if (c == '"' || c == '\\') std::fputc('\\', f);
+        if ((unsigned char)c >= 0x20) std::fputc(c, f);
+    }
+}
+}
+
+long EventTracer::dumpChromeJson(const std::string& path){
+    std::vector<Decoded> evs;
+    std::map<uint32_t, std::string> names;
+    uint64_t origin;
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        names = names_;
+        origin = originNs_;
+        for (auto& r : rings_) {
+            const uint64_t head = r->head.load(std::memory_order_acquire);
+            const uint64_t first = head > r->size ? head - r->size : 0;
+            for (uint64_t i = first; i < head; ++i) {
+                Ring::Slot& s = r->slots[i & r->mask];
+                const uint64_t s1 = s.stamp.load(std::memory_order_acquire);
+                const uint64_t ts = s.ts.load(std::memory_order_relaxed);
+                const uint64_t a  = s.a.load(std::memory_order_relaxed);
+                const uint64_t b  = s.b.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                const uint64_t s2 = s.stamp.load(std::memory_order_relaxed);
+                if (s1 != i + 1 || s2 != s1) continue; // yazar bu slotu ezdi
+                Decoded d;
+                d.ts = ts; d.dur = a >> 32; d.seq = uint16_t(a >> 16); d.ev = uint8_t(a);
+                d.tid = uint32_t(b >> 32); d.arg = uint32_t(b);
+                if (d.ev < (uint8_t)TraceEv::COUNT && ts >= origin) evs.push_back(d);
+            }
+        }
+    }
+    std::sort(evs.begin(), evs.end(), [](const Decoded& x, const Decoded& y){ return x.ts < y.ts; });
+
+    std::FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) { std::perror("event trace"); return -1; }
+
+    std::fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    for (const auto& kv : names) {
+        std::fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"",
+                     first ? "" : ",\n", kv.first);
+        writeEscaped(f, kv.second);
+        std::fprintf(f, "\"}}");
+        first = false;
+    }
+    for (const auto& e : evs) {
+        const EvInfo& in = kEvInfo[e.ev];
+        const double tsUs = (e.ts - origin) / 1000.0;
+        std::fprintf(f, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"pid\":1,\"tid\":%u,\"ts\":%.3f",
+                     first ? "" : ",\n", in.name, in.cat, e.tid, tsUs);
+        if (e.dur) std::fprintf(f, ",\"ph\":\"X\",\"dur\":%.3f", e.dur / 1000.0);
+        else       std::fprintf(f, ",\"ph\":\"i\",\"s\":\"t\"");
+        std::fprintf(f, ",\"args\":{");
+        if (in.seqKey) std::fprintf(f, "\"%s\":%u", in.seqKey, (unsigned)e.seq);
+        if (in.argKey) std::fprintf(f, "%s\"%s\":%u", in.seqKey ? "," : "", in.argKey, e.arg);
+        std::fprintf(f, "}}");
+        first = false;
+    }
+    std::fprintf(f, "\n]}\n");
+    std::fclose(f);
+    return (long)evs.size();
+}
@@ -0,0 +1,19 @@
+#include "FramePipeline.hpp"
+#include <algorithm>
+#include <cmath>
+
+float framekernels::rmsFromEnergy(double energy, int n){
+    return (float)std::sqrt(energy / std::max(1,n));
+}
+
+float framekernels::rmsDynamic(const int16_t* pcm, int n){
+    double s=0; for (int i=0;i<n;i++){ s += double(pcm[i])*pcm[i]; }
+    return rmsFromEnergy(s, n);
+}
+
+void FramePipeline::configure(int sampleRate, int frameMs){
+    if (sampleRate == 16000 && frameMs == 20)      v_.emplace<FixedFramePipeline<16000,20>>();
+    else if (sampleRate == 48000 && frameMs == 10) v_.emplace<FixedFramePipeline<48000,10>>();
+    else if (sampleRate == 48000 && frameMs == 20) v_.emplace<FixedFramePipeline<48000,20>>();
+    else v_.emplace<DynamicFramePipeline>(sampleRate * frameMs / 1000);
+}
@@ -0,0 +1,162 @@
+#include "NoiseSuppressorNative.hpp"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define LIFEMESH_NS_SSE 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define LIFEMESH_NS_NEON 1
+#endif
+
+// ---------- SIMD kernel'leri ----------
+namespace {
+// dst[i] = a[i] * b[i]
+void mulVec(float* dst, const float* a, const float* b, int n){
+    int i = 0;
+#if defined(LIFEMESH_NS_SSE)
+    for (; i+4<=n; i+=4) _mm_storeu_ps(dst+i, _mm_mul_ps(_mm_loadu_ps(a+i), _mm_loadu_ps(b+i)));
+#elif defined(LIFEMESH_NS_NEON)
+    for (; i+4<=n; i+=4) vst1q_f32(dst+i, vmulq_f32(vld1q_f32(a+i), vld1q_f32(b+i)));
+#endif
+    for (; i<n; ++i) dst[i] = a[i] * b[i];
+}
+
+// pw[i] = re[i]^2 + im[i]^2
+void powerVec(float* pw, const float* re, const float* im, int n){
+    int i = 0;
+#if defined(LIFEMESH_NS_SSE)
+    for (; i+4<=n; i+=4) {
+        __m128 r = _mm_loadu_ps(re+i), m = _mm_loadu_ps(im+i);
+        _mm_storeu_ps(pw+i, _mm_add_ps(_mm_mul_ps(r,r), _mm_mul_ps(m,m)));
+    }
+#elif defined(LIFEMESH_NS_NEON)
+    for (; i+4<=n; i+=4) {
+        float32x4_t r = vld1q_f32(re+i), m = vld1q_f32(im+i);
+        vst1q_f32(pw+i, vmlaq_f32(vmulq_f32(r,r), m, m));
+    }
+#endif
+    for (; i<n; ++i) pw[i] = re[i]*re[i] + im[i]*im[i];
+}
+
+// re[i] *= g[i], im[i] *= g[i]
+void scaleComplexVec(float* re, float* im, const float* g, int n){
+    int i = 0;
+#if defined(LIFEMESH_NS_SSE)
+    for (; i+4<=n; i+=4) {
+        __m128 gg = _mm_loadu_ps(g+i);
+        _mm_storeu_ps(re+i, _mm_mul_ps(_mm_loadu_ps(re+i), gg));
+        _mm_storeu_ps(im+i, _mm_mul_ps(_mm_loadu_ps(im+i), gg));
+    }
+#elif defined(LIFEMESH_NS_NEON)
+    for (; i+4<=n; i+=4) {
+        float32x4_t gg = vld1q_f32(g+i);
+        vst1q_f32(re+i, vmulq_f32(vld1q_f32(re+i), gg));
+        vst1q_f32(im+i, vmulq_f32(vld1q_f32(im+i), gg));
+    }
+#endif
+    for (; i<n; ++i) { re[i] *= g[i]; im[i] *= g[i]; }
+}
+}
+
+// ---------- NoiseSuppressorNative ----------
+bool NoiseSuppressorNative::init(int, int frameSize, int suppressDb){
+    if (frameSize <= 0) return false;
+    frame_ = frameSize;
+    win_ = 2 * frameSize;
+    nfft_ = 1; int log2n = 0;
+    while (nfft_ < win_) { nfft_ <<= 1; log2n++; }
+    bins_ = nfft_/2 + 1;
+    gainFloor_ = std::pow(10.0f, std::min(0, suppressDb) / 20.0f);
+    warmup_ = 0;
+
+    // Periyodik Hann: %50 overlap'te toplamı 1 (ayrı sentez penceresi gerekmez)
+    window_.resize(win_);
+    for (int i=0;i<win_;++i) window_[i] = 0.5f - 0.5f * std::cos(2.0f * float(M_PI) * i / win_);
+
+    inBuf_.assign(win_, 0.f);
+    ola_.assign(frame_, 0.f);
+    re_.assign(nfft_, 0.f); im_.assign(nfft_, 0.f);
+    gainFull_.assign(nfft_, 1.f);
+    pw_.assign(bins_, 0.f); smooth_.assign(bins_, 0.f); noise_.assign(bins_, 0.f);
+    gain_.assign(bins_, 1.f); post_.assign(bins_, 1.f);
+
+    cos_.resize(nfft_/2); sin_.resize(nfft_/2);
+    for (int k=0;k<nfft_/2;++k) {
+        cos_[k] = std::cos(2.0 * M_PI * k / nfft_);
+        sin_[k] = std::sin(2.0 * M_PI * k / nfft_);
+    }
+    rev_.resize(nfft_);
+    for (int i=0;i<nfft_;++i) {
+        uint32_t r = 0;
+        for (int b=0;b<log2n;++b) if (i & (1<<b)) r |= 1u << (log2n-1-b);
+        rev_[i] = r;
+    }
+    return true;
+}
+
+void NoiseSuppressorNative::fft(bool inverse){
+    for (int i=0;i<nfft_;++i) {
+        uint32_t j = rev_[i];
+        if ((int)j > i) { std::swap(re_[i], re_[j]); std::swap(im_[i], im_[j]); }
+    }
+    const float sgn = inverse ? 1.f : -1.f;
+    for (int len=2; len<=nfft_; len<<=1) {
+        const int half = len/2, step = nfft_/len;
+        for (int i=0;i<nfft_;i+=len) {
+            for (int k=0;k<half;++k) {
+                const float wr = cos_[k*step], wi = sgn * sin_[k*step];
+                const int a = i+k, b = i+k+half;
+                const float tr = re_[b]*wr - im_[b]*wi;
+                const float ti = re_[b]*wi + im_[b]*wr;
+                re_[b] = re_[a] - tr; im_[b] = im_[a] - ti;
+                re_[a] += tr;         im_[a] += ti;
+            }
+        }
+    }
+}
+
+void NoiseSuppressorNative::process(int16_t* pcm, int frameSize){
+    if (frameSize != frame_ || frame_ == 0) return;
+
+    // ---- analiz: [önceki frame | şimdiki frame] * Hann, sıfır dolgulu FFT
+    std::copy(inBuf_.begin() + frame_, inBuf_.end(), inBuf_.begin());
+    for (int i=0;i<frame_;++i) inBuf_[frame_+i] = float(pcm[i]);
+    mulVec(re_.data(), inBuf_.data(), window_.data(), win_);
+    std::fill(re_.begin() + win_, re_.end(), 0.f);
+    std::fill(im_.begin(), im_.end(), 0.f);
+    fft(false);
+
+    // ---- gürültü takibi + decision-directed Wiener kazancı
+    powerVec(pw_.data(), re_.data(), im_.data(), bins_);
+    const bool learning = warmup_ < 10;
+    for (int k=0;k<bins_;++k) {
+        smooth_[k] = 0.7f * smooth_[k] + 0.3f * pw_[k];
+        float n = noise_[k];
+        if (learning)            n = (n * warmup_ + smooth_[k]) / float(warmup_ + 1);
+        else if (smooth_[k] < n) n = 0.9f * n + 0.1f * smooth_[k];
+        else                     n = std::min(n * 1.005f + 1e-3f, smooth_[k]);
+        noise_[k] = n;
+
+        const float post = pw_[k] / (n + 1e-6f);
+        const float prio = 0.98f * gain_[k] * gain_[k] * post_[k] + 0.02f * std::max(post - 1.f, 0.f);
+        gain_[k] = std::max(prio / (1.f + prio), gainFloor_);
+        post_[k] = post;
+    }
+    if (learning) warmup_++;
+
+    // ---- kazancı uygula (aynalanmış tam spektrum), ters FFT
+    for (int k=0;k<bins_;++k) gainFull_[k] = gain_[k];
+    for (int k=1;k<nfft_/2;++k) gainFull_[nfft_-k] = gain_[k];
+    scaleComplexVec(re_.data(), im_.data(), gainFull_.data(), nfft_);
+    fft(true);
+
+    // ---- overlap-add
+    const float inv = 1.0f / nfft_;
+    for (int i=0;i<frame_;++i) {
+        float y = ola_[i] + re_[i] * inv;
+        ola_[i] = re_[frame_+i] * inv;
+        pcm[i] = (int16_t)std::clamp(y, -32768.f, 32767.f);
+    }
+}
@@ -1,6 +1,11 @@
 #include "NoiseSuppressorSpeex.hpp"
 #include <iostream>
 
+#ifdef LIFEMESH_HAVE_SPEEXDSP
+#include <speex/speex_preprocess.h>
+
+bool NoiseSuppressorSpeex::available() { return true; }
+
 NoiseSuppressorSpeex::NoiseSuppressorSpeex() {}
 NoiseSuppressorSpeex::~NoiseSuppressorSpeex() {
     if (st_) {
@@ -9,7 +14,8 @@ NoiseSuppressorSpeex::~NoiseSuppressorSpeex() {
     }
 }
 
-bool NoiseSuppressorSpeex::init(int sampleRate, int frameSize, bool enableAgc, int agcTarget) {
+bool NoiseSuppressorSpeex::init(int sampleRate, int frameSize, int suppressDb, bool enableAgc,
+                               int agcTarget, int agcMaxGainDb) {
     sampleRate_ = sampleRate;
     frameSize_ = frameSize;
 
@@ -23,7 +29,7 @@ bool NoiseSuppressorSpeex::init(int sampleRate, int frameSize, bool enableAgc, i
 
     // Noise suppression (hafif, sesi boğmayacak şekilde)
     speex_preprocess_ctl(st_, SPEEX_PREPROCESS_SET_DENOISE, &i);
-    int noiseSuppressDb = -15;  // daha az agresif (önceden -30’du)
+    int noiseSuppressDb = suppressDb;
     speex_preprocess_ctl(st_, SPEEX_PREPROCESS_SET_NOISE_SUPPRESS, &noiseSuppressDb);
 
     // VAD'i kapatıyoruz, çünkü kendi VAD zincirimiz var
@@ -36,6 +42,8 @@ bool NoiseSuppressorSpeex::init(int sampleRate, int frameSize, bool enableAgc, i
         speex_preprocess_ctl(st_, SPEEX_PREPROCESS_SET_AGC, &i);
         int target = agcTarget > 0 ? agcTarget : 16000; // default 16k amplitude
         speex_preprocess_ctl(st_, SPEEX_PREPROCESS_SET_AGC_TARGET, &target);
+        int maxGain = agcMaxGainDb;
+        speex_preprocess_ctl(st_, SPEEX_PREPROCESS_SET_AGC_MAX_GAIN, &maxGain);
     }
 
     // Reverb removal opsiyonel (kapalı bırakıyoruz)
@@ -46,7 +54,21 @@ bool NoiseSuppressorSpeex::init(int sampleRate, int frameSize, bool enableAgc, i
 }
 
 void NoiseSuppressorSpeex::process(int16_t* pcm, int frameSize) {
-    if (!st_) return;
+    if (!st_ || frameSize != frameSize_) return;
     int vad = speex_preprocess_run(st_, pcm);
     (void)vad; // kendi VAD zincirimiz var, bunu kullanmıyoruz
 }
+
+#else // SpeexDSP yok: stub
+
+bool NoiseSuppressorSpeex::available() { return false; }
+NoiseSuppressorSpeex::NoiseSuppressorSpeex() {}
+NoiseSuppressorSpeex::~NoiseSuppressorSpeex() {}
+bool NoiseSuppressorSpeex::init(int sampleRate, int frameSize, int, bool, int, int) {
+    sampleRate_ = sampleRate;
+    frameSize_ = frameSize;
+    return false;
+}
+void NoiseSuppressorSpeex::process(int16_t*, int) {}
+
+#endif
@@ -0,0 +1,413 @@
+#include "PacketFec.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+// ---------- GF(256) (x^8+x^4+x^3+x^2+1) ----------
+namespace {
+struct Gf256 {
+    uint8_t exp[512];
+    uint8_t log[256];
+    Gf256(){
+        int x = 1;
+        for (int i=0;i<255;++i) {
+            exp[i] = (uint8_t)x; log[x] = (uint8_t)i;
+            x <<= 1; if (x & 0x100) x ^= 0x11d;
+        }
+        for (int i=255;i<512;++i) exp[i] = exp[i-255];
+        log[0] = 0;
+    }
+    uint8_t mul(uint8_t a, uint8_t b) const { return (a && b) ? exp[log[a] + log[b]] : 0; }
+    uint8_t inv(uint8_t a) const { return exp[255 - log[a]]; }
+};
+const Gf256& gf(){ static const Gf256 t; return t; }
+
+// dst ^= c * src
+void mulAdd(uint8_t* dst, const uint8_t* src, uint8_t c, size_t n){
+    if (c == 0) return;
+    if (c == 1) { for (size_t i=0;i<n;++i) dst[i] ^= src[i]; return; }
+    const Gf256& g = gf();
+    const int lc = g.log[c];
+    for (size_t i=0;i<n;++i) if (src[i]) dst[i] ^= g.exp[lc + g.log[src[i]]];
+}
+void scale(uint8_t* v, uint8_t c, size_t n){
+    const Gf256& g = gf();
+    for (size_t i=0;i<n;++i) v[i] = g.mul(v[i], c);
+}
+
+// Parity satırı 'row', medya 'i' katsayısı. XOR: hep 1; RS: Cauchy 1/(x_row ^ y_i),
+// y_i = i, x_row = k + row (ayrık olduklarından payda sıfır olmaz).
+uint8_t coef(uint8_t coding, int k, int row, int i){
+    if (coding == FecParams::XOR) return 1;
+    return gf().inv((uint8_t)((k + row) ^ i));
+}
+
+uint32_t nowMs(){
+    using namespace std::chrono;
+    return (uint32_t)duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Birim: [u16 uzunluk][paket], L'ye sıfırla doldurulmuş
+void makeUnit(std::vector<uint8_t>& unit, const uint8_t* pkt, size_t len, size_t L){
+    unit.assign(L, 0);
+    unit[0] = (uint8_t)(len & 0xff); unit[1] = (uint8_t)(len >> 8);
+    std::memcpy(unit.data() + 2, pkt, std::min(len, L - 2));
+}
+}
+
+// ---------- FecTransport ----------
+FecTransport::FecTransport(ITransport* inner, const FecParams& fp)
+: inner_(inner), fp_(fp), ring_(RING) {
+    // Adaptif modda kanal temiz varsayılır; ilk kayıp raporuyla devreye girer.
+    txActive_ = fp.enabled && !fp.adaptive;
+    txCoding_ = fp.m > 1 ? FecParams::RS : fp.coding;
+    txK_ = std::clamp(fp.k, 2, 32);
+    txM_ = std::clamp(fp.m, 1, std::max(1, fp.maxParity));
+    txD_ = std::clamp(fp.interleave, 1, std::max(1, fp.maxInterleave));
+    fitDelay(txK_, txD_);
+}
+
+FecStats FecTransport::stats() const {
+    FecStats st;
+    {
+        std::lock_guard<std::mutex> lk(txMu_);
+        st.active = txActive_; st.k = txK_; st.m = txM_; st.interleave = txD_;
+    }
+    st.paritySent = paritySent_;
+    st.recovered = recovered_;
+    st.recoveredLate = recoveredLate_;
+    st.unrecoverable = unrecoverable_;
+    st.peerLoss = peerLossPermille_ / 1000.0;
+    st.peerMaxBurst = peerMaxBurst_;
+    return st;
+}
+
+// ---------- gönderici ----------
+bool FecTransport::send(const uint8_t* data, size_t len){
+    bool ok = inner_->send(data, len);
+    if (!fp_.enabled || len < sizeof(MeshVoiceHeader)) return ok;
+    MeshVoiceHeader hdr{};
+    std::memcpy(&hdr, data, sizeof(hdr));
+    if (hdr.flags & (MVH_FLAG_PARITY | MVH_FLAG_FEC_REPORT)) return ok;
+
+    std::lock_guard<std::mutex> lk(txMu_);
+    if (!txActive_) { blockSet_ = false; return ok; }
+
+    const uint16_t span = (uint16_t)(txD_ * txK_);
+    uint16_t off = (uint16_t)(hdr.seq - blockStart_);
+    if (!blockSet_ || off >= span) {
+        // Ardışık devam ya da seq sıçraması: yeni blok (yarım gruplar korumasız kalır)
+        blockStart_ = hdr.seq; blockSet_ = true; off = 0;
+        txUnits_.assign(span, std::vector<uint8_t>());
+    }
+    std::vector<uint8_t>& u = txUnits_[off];
+    u.resize(len + 2);
+    u[0] = (uint8_t)(len & 0xff); u[1] = (uint8_t)(len >> 8);
+    std::memcpy(u.data() + 2, data, len);
+
+    const int group = off % txD_, pos = off / txD_;
+    if (pos == txK_ - 1) emitParity(group, hdr.tsMs);
+    return ok;
+}
+
+void FecTransport::emitParity(int group, uint32_t tsMs){
+    size_t L = 0;
+    for (int i=0;i<txK_;++i) {
+        const auto& u = txUnits_[group + i*txD_];
+        if (u.empty()) return;      // eksik üye (blok ortasında sıfırlandı)
+        L = std::max(L, u.size());
+    }
+    MeshVoiceHeader lastHdr{};
+    std::memcpy(&lastHdr, txUnits_[group].data() + 2, sizeof(lastHdr));
+
+    const size_t off = sizeof(MeshVoiceHeader) + sizeof(FecParityHeader);
+    for (int row=0; row<txM_; ++row) {
+        parityBuf_.assign(off + L, 0);
+        uint8_t* par = parityBuf_.data() + off;
+        for (int i=0;i<txK_;++i) {
+            const auto& u = txUnits_[group + i*txD_];
+            mulAdd(par, u.data(), coef(txCoding_, txK_, row, i), u.size());
+        }
+        MeshVoiceHeader hdr{};
+        hdr.flags = MVH_FLAG_PARITY;
+        hdr.seq = (uint16_t)(blockStart_ + group);
+        hdr.convId = lastHdr.convId;
+        hdr.tsMs = tsMs;
+        hdr.payLen = 0; // eski alıcılar jitter buffer'a sokmasın; gövde = datagram - header
+        FecParityHeader ph{};
+        ph.baseSeq = hdr.seq;
+        ph.k = (uint8_t)txK_; ph.m = (uint8_t)txM_; ph.index = (uint8_t)row;
+        ph.stride = (uint8_t)txD_; ph.coding = (uint8_t)txCoding_; ph.len = (uint16_t)L;
+        std::memcpy(parityBuf_.data(), &hdr, sizeof(hdr));
+        std::memcpy(parityBuf_.data() + sizeof(hdr), &ph, sizeof(ph));
+        if (inner_->send(parityBuf_.data(), parityBuf_.size())) paritySent_++;
+    }
+}
+
+void FecTransport::onReport(const FecReport& rep){
+    // Multicast'te her alıcının raporu gelir: son iki rapor penceresinin en kötüsü
+    // kullanılır. Böylece her alıcının son raporu hesaba girer ve k/m/D rapor sırasına
+    // göre gidip gelmez. Tek alıcıda iyileşme bir pencere gecikmeyle yansır.
+    const uint32_t now = nowMs(), win = (uint32_t)std::max(1, fp_.reportMs);
+    if (!repWinSet_ || now - repWinStartMs_ >= win) {
+        const bool stale = !repWinSet_ || now - repWinStartMs_ >= 2 * win;
+        if (repWinSet_) cleanWindows_ = winLoss_ < 10 && winBurst_ <= 1 ? cleanWindows_ + 1 : 0;
+        prevLoss_ = stale ? 0 : winLoss_; prevBurst_ = stale ? 0 : winBurst_;
+        winLoss_ = 0; winBurst_ = 0;
+        repWinStartMs_ = now; repWinSet_ = true;
+    }
+    winLoss_ = std::max(winLoss_, rep.lossPermille);
+    winBurst_ = std::max(winBurst_, rep.maxBurst);
+    const uint16_t lossPermille = std::max(prevLoss_, winLoss_);
+    const uint8_t maxBurst = std::max(prevBurst_, winBurst_);
+
+    peerLossPermille_ = lossPermille;
+    peerMaxBurst_ = maxBurst;
+    if (!fp_.enabled || !fp_.adaptive) return;
+
+    bool changed = false;
+    {
+        std::lock_guard<std::mutex> lk(txMu_);
+        const double loss = lossPermille / 1000.0;
+        const int burst = maxBurst;
+
+        // Tekil kayıpları Opus in-band FEC karşılıyor; parity sadece burst/yüksek kayıpta.
+        if (loss < 0.01 && burst <= 1) {
+            if (cleanWindows_ >= 3 && txActive_) { txActive_ = false; blockSet_ = false; changed = true; }
+        } else {
+            cleanWindows_ = 0;
+
+            int k, m, d;
+            FecParams::Coding c;
+            if (burst <= 1) {
+                c = FecParams::XOR; m = 1; d = 1;
+                k = loss < 0.05 ? 8 : 4;
+            } else {
+                d = std::min(burst, std::max(1, fp_.maxInterleave));
+                m = std::min(std::max(1, fp_.maxParity), (burst + d - 1) / d);
+                c = m > 1 ? FecParams::RS : FecParams::XOR;
+                k = loss > 0.15 ? 4 : 6;
+            }
+            if (fitDelay(k, d)) {
+                m = std::min(std::max(1, fp_.maxParity), (burst + d - 1) / d);
+                c = m > 1 ? FecParams::RS : FecParams::XOR;
+            }
+            if (!txActive_ || k != txK_ || m != txM_ || d != txD_ || c != txCoding_) {
+                txK_ = k; txM_ = m; txD_ = d; txCoding_ = c;
+                txActive_ = true; blockSet_ = false; changed = true;
+            }
+        }
+    }
+    // Parity ek yükü değişti: alttaki pacing katmanının hızı da değişir
+    if (changed) forwardRate();
+}
+
+int FecTransport::delayFrames() const {
+    return std::max(1, fp_.maxDelayMs / std::max(1, fp_.frameMs));
+}
+
+// İlk üye parity'yi (k-1)*d frame bekler: önce k, yetmezse derinlik küçülür.
+// Derinlik değiştiyse true (m ona göre yeniden seçilmeli).
+bool FecTransport::fitDelay(int& k, int& d) const {
+    const int span = delayFrames();
+    if ((k - 1) * d > span) k = std::max(2, span / d + 1);
+    if ((k - 1) * d <= span) return false;
+    d = std::max(1, span);
+    return true;
+}
+
+void FecTransport::setSendRate(int bps){
+    baseRateBps_ = bps;
+    forwardRate();
+}
+
+void FecTransport::forwardRate(){
+    const int bps = baseRateBps_;
+    if (bps <= 0) return;
+    bool active; int k, m;
+    {
+        std::lock_guard<std::mutex> lk(txMu_);
+        active = txActive_; k = txK_; m = txM_;
+    }
+    // parity paketleri grup üyeleri kadar büyük: her k medya paketine m paket eklenir
+    inner_->setSendRate(active ? (int)((int64_t)bps * (k + m) / k) : bps);
+}
+
+// ---------- alıcı ----------
+void FecTransport::onReceive(RxHandler h){
+    rx_ = std::move(h);
+    inner_->onReceive([this](const uint8_t* d, size_t l){ onInnerRx(d, l); });
+}
+
+void FecTransport::onInnerRx(const uint8_t* data, size_t len){
+    if (len < sizeof(MeshVoiceHeader)) { if (rx_) rx_(data, len); return; }
+    MeshVoiceHeader hdr{};
+    std::memcpy(&hdr, data, sizeof(hdr));
+
+    if (hdr.flags & MVH_FLAG_FEC_REPORT) {
+        if (len >= sizeof(hdr) + sizeof(FecReport)) {
+            FecReport rep{};
+            std::memcpy(&rep, data + sizeof(hdr), sizeof(rep));
+            onReport(rep);
+        }
+        return;
+    }
+    if (hdr.flags & MVH_FLAG_PARITY) { onParity(data, len); return; }
+    onMedia(hdr, data, len);
+}
+
+void FecTransport::storeMedia(uint16_t seq, const uint8_t* data, size_t len){
+    Slot& s = ring_[seq % RING];
+    if (s.pkt.capacity() == 0) s.pkt.reserve(kMaxFramePacket);
+    s.valid = true; s.seq = seq;
+    s.pkt.assign(data, data + len);
+}
+
+void FecTransport::onMedia(const MeshVoiceHeader& hdr, const uint8_t* data, size_t len){
+    convId_ = hdr.convId;
+    Slot& slot = ring_[hdr.seq % RING];
+    const bool known = slot.seq == hdr.seq;
+    const bool wasLost = known && slot.lost;
+    const bool dup = known && slot.valid && !slot.lost;
+
+    // ham kanal kaybı / burst ölçümü (kurtarılanlar sayılmaz; kopyalar sayaçlara girmez)
+    if (!dup) {
+        intervalRx_++;
+        const int16_t d = (int16_t)(hdr.seq - lastSeq_);
+        if (!haveLast_) { haveLast_ = true; lastSeq_ = hdr.seq; }
+        else if (d > 0) {
+            int gap = d - 1;
+            if (gap > 0 && gap < 100) { // daha büyük sıçrama: yeniden senkron, kayıp değil
+                intervalLost_ += gap; burstCount_++; burstSum_ += gap;
+                maxBurst_ = (uint8_t)std::max<int>(maxBurst_, std::min(gap, 255));
+                for (int i=1;i<=gap;++i) {
+                    Slot& m = ring_[(uint16_t)(lastSeq_ + i) % RING];
+                    m.valid = false; m.lost = true; m.seq = (uint16_t)(lastSeq_ + i);
+                }
+            }
+            lastSeq_ = hdr.seq;
+        } else if (wasLost && intervalLost_ > 0) {
+            intervalLost_--; // geç gelen: atlanırken kayıp sayılmıştı
+        }
+    }
+    slot.lost = false;
+    if (wasLost && slot.valid) { // FEC ile zaten kurtarılıp iletilmişti
+        maybeSendReport(nowMs());
+        return;
+    }
+    storeMedia(hdr.seq, data, len);
+
+    if (rx_) rx_(data, len);
+    maybeSendReport(nowMs());
+}
+
+void FecTransport::maybeSendReport(uint32_t now){
+    if (now - lastReportMs_ < (uint32_t)fp_.reportMs || intervalRx_ == 0) return;
+    lastReportMs_ = now;
+
+    FecReport rep{};
+    uint32_t total = intervalRx_ + intervalLost_;
+    rep.lossPermille = (uint16_t)(uint64_t(intervalLost_) * 1000 / std::max<uint32_t>(1, total));
+    rep.received = (uint16_t)std::min<uint32_t>(intervalRx_, 0xFFFF);
+    rep.maxBurst = maxBurst_;
+    rep.meanBurstX10 = (uint8_t)std::min<uint32_t>(255, burstCount_ ? burstSum_ * 10 / burstCount_ : 0);
+    intervalRx_ = intervalLost_ = burstCount_ = burstSum_ = 0; maxBurst_ = 0;
+
+    MeshVoiceHeader hdr{};
+    hdr.flags = MVH_FLAG_FEC_REPORT;
+    hdr.convId = convId_;
+    hdr.tsMs = now;
+    hdr.payLen = 0; // bkz. emitParity
+    uint8_t pkt[sizeof(MeshVoiceHeader) + sizeof(FecReport)];
+    std::memcpy(pkt, &hdr, sizeof(hdr));
+    std::memcpy(pkt + sizeof(hdr), &rep, sizeof(rep));
+    inner_->send(pkt, sizeof(pkt));
+}
+
+void FecTransport::onParity(const uint8_t* data, size_t len){
+    if (len < sizeof(MeshVoiceHeader) + sizeof(FecParityHeader)) return;
+    const size_t body = len - sizeof(MeshVoiceHeader) - sizeof(FecParityHeader);
+    FecParityHeader ph{};
+    std::memcpy(&ph, data + sizeof(MeshVoiceHeader), sizeof(ph));
+    if (ph.k == 0 || ph.m == 0 || ph.index >= ph.m || ph.stride == 0 || ph.len < 2 ||
+        ph.len > body || (size_t)ph.k * ph.stride > RING/2) return;
+
+    ParityGroup& g = groups_[ph.baseSeq];
+    if (g.rows.empty() || g.k != ph.k || g.stride != ph.stride || g.len != ph.len || g.coding != ph.coding) {
+        g = ParityGroup{};
+        g.k = ph.k; g.m = ph.m; g.stride = ph.stride; g.coding = ph.coding; g.len = ph.len;
+    }
+    if (!g.done) {
+        const uint8_t* par = data + sizeof(MeshVoiceHeader) + sizeof(ph);
+        g.rows[ph.index].assign(par, par + ph.len);
+        tryRecover(ph.baseSeq, g);
+    }
+
+    // eski grupları at
+    for (auto it = groups_.begin(); it != groups_.end(); ) {
+        if ((int16_t)(ph.baseSeq - it->first) > 512) it = groups_.erase(it); else ++it;
+    }
+}
+
+void FecTransport::tryRecover(uint16_t base, ParityGroup& g){
+    std::vector<int> missing;
+    for (int i=0;i<g.k;++i) {
+        uint16_t seq = (uint16_t)(base + i*g.stride);
+        const Slot& s = ring_[seq % RING];
+        if (!(s.valid && s.seq == seq)) missing.push_back(i);
+    }
+    if (missing.empty()) { g.done = true; return; }
+    if (missing.size() > g.rows.size()) {
+        if (g.rows.size() == g.m) { unrecoverable_++; g.done = true; }
+        return;
+    }
+
+    const size_t e = missing.size(), L = g.len;
+    std::vector<int> rows;
+    for (auto& r : g.rows) { if (rows.size() < e) rows.push_back(r.first); }
+
+    // Sendromlar: S_j = parity_j ^ sum(coef * bilinen birim)
+    std::vector<std::vector<uint8_t>> S(e);
+    std::vector<uint8_t> unit;
+    for (size_t j=0;j<e;++j) S[j] = g.rows[(uint8_t)rows[j]];
+    for (int i=0;i<g.k;++i) {
+        if (std::find(missing.begin(), missing.end(), i) != missing.end()) continue;
+        const Slot& s = ring_[(uint16_t)(base + i*g.stride) % RING];
+        if (s.pkt.size() + 2 > L) return; // tutarsız grup
+        makeUnit(unit, s.pkt.data(), s.pkt.size(), L);
+        for (size_t j=0;j<e;++j) mulAdd(S[j].data(), unit.data(), coef(g.coding, g.k, rows[j], i), L);
+    }
+
+    // A x = S, A[j][t] = coef(row_j, missing_t); GF(256) Gauss eleme
+    std::vector<std::vector<uint8_t>> A(e, std::vector<uint8_t>(e));
+    for (size_t j=0;j<e;++j)
+        for (size_t t=0;t<e;++t) A[j][t] = coef(g.coding, g.k, rows[j], missing[t]);
+    for (size_t col=0; col<e; ++col) {
+        size_t piv = col;
+        while (piv < e && A[piv][col] == 0) piv++;
+        if (piv == e) return; // tekil (XOR'da çoklu kayıp)
+        std::swap(A[piv], A[col]); std::swap(S[piv], S[col]);
+        uint8_t iv = gf().inv(A[col][col]);
+        scale(A[col].data(), iv, e); scale(S[col].data(), iv, L);
+        for (size_t r=0;r<e;++r) {
+            if (r == col || A[r][col] == 0) continue;
+            uint8_t f = A[r][col];
+            mulAdd(A[r].data(), A[col].data(), f, e);
+            mulAdd(S[r].data(), S[col].data(), f, L);
+        }
+    }
+
+    g.done = true;
+    for (size_t t=0;t<e;++t) {
+        const uint8_t* u = S[t].data();
+        size_t plen = size_t(u[0]) | (size_t(u[1]) << 8);
+        if (plen < sizeof(MeshVoiceHeader) || plen + 2 > L) continue;
+        uint16_t seq = (uint16_t)(base + missing[t]*g.stride);
+        storeMedia(seq, u + 2, plen);
+        // Bütçeden geç olsa da iletilir: jitter buffer eksik seq'i atlamaz, onu bekler;
+        // gerçekten geçilmişse (d<0) push kendisi atar.
+        recovered_++;
+        if ((int16_t)(lastSeq_ - seq) > delayFrames()) recoveredLate_++;
+        if (rx_) rx_(u + 2, plen);
+    }
+}
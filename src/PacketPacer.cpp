@@ -0,0 +1,213 @@
+#include "PacketPacer.hpp"
+#include "EventTrace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace {
+uint64_t steadyNs(){
+    using namespace std::chrono;
+    return (uint64_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+}
+
+// ---------- PacerTransport ----------
+PacerTransport::PacerTransport(ITransport* inner, const PacerParams& pp)
+: inner_(inner), pp_(pp) {
+    rateBps_ = std::clamp(pp_.initialRateBps, pp_.minRateBps, std::max(pp_.minRateBps, pp_.maxRateBps));
+    applyRate();
+    link_.tokens = link_.depth;
+    for (auto& b : cls_) b.tokens = b.depth;
+}
+
+bool PacerTransport::start(){
+    std::lock_guard<std::mutex> lk(mu_);
+    if (running_ || !pp_.enabled) return true;
+    running_ = true;
+    lastRefillNs_ = steadyNs();
+    th_ = std::thread([this]{ flushLoop(); });
+    return true;
+}
+
+void PacerTransport::stop(){
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        if (!running_) return;
+        running_ = false;
+        // kapanışta bekleyenler gönderilmez
+        for (int c=0;c<PACE_CLASSES;++c) { dropped_[c] += q_[c].size(); q_[c].clear(); }
+        backlog_ = 0;
+    }
+    cv_.notify_all();
+    if (th_.joinable()) th_.join();
+}
+
+PaceClass PacerTransport::classify(const uint8_t* data, size_t len){
+    if (len < sizeof(MeshVoiceHeader)) return PaceClass::PROBE;
+    MeshVoiceHeader hdr{};
+    std::memcpy(&hdr, data, sizeof(hdr));
+    if (hdr.version != 1) return PaceClass::PROBE;
+    if (hdr.flags & MVH_FLAG_FEC_REPORT) return PaceClass::CONTROL;
+    if (hdr.flags & MVH_FLAG_PARITY) return PaceClass::FEC;
+    return hdr.hop ? PaceClass::RELAY : PaceClass::MEDIA;
+}
+
+void PacerTransport::setSendRate(int bps){
+    std::lock_guard<std::mutex> lk(mu_);
+    rateBps_ = std::clamp((int)(bps * pp_.pacingFactor), pp_.minRateBps,
+                          std::max(pp_.minRateBps, pp_.maxRateBps));
+    applyRate();
+}
+
+// Kova derinliği burstMs kadar bayt, en az bir MTU (düşük hızda kova tek paketten sığ
+// kalıp her paketi borçla göndermesin); en fazla bir paketlik borca girilebilir (canSend).
+void PacerTransport::applyRate(){
+    const double burstSec = std::max(1, pp_.burstMs) / 1000.0;
+    const double minDepth = std::max(1, pp_.mtuBytes);
+    link_.rateBps = rateBps_;
+    link_.depth = std::max(minDepth, rateBps_ * burstSec / 8);
+    link_.tokens = std::min(link_.tokens, link_.depth);
+    for (int c=0;c<PACE_CLASSES;++c) {
+        Bucket& b = cls_[c];
+        b.rateBps = std::max(0.0, pp_.share[c]) * rateBps_;   // 0: sınıf sınırı yok
+        b.depth = std::max(minDepth, b.rateBps * burstSec / 8);
+        b.tokens = std::min(b.tokens, b.depth);
+    }
+}
+
+void PacerTransport::refill(uint64_t nowNs){
+    if (nowNs <= lastRefillNs_) return;
+    const double dt = (nowNs - lastRefillNs_) / 1e9;
+    lastRefillNs_ = nowNs;
+    link_.tokens = std::min(link_.depth, link_.tokens + link_.rateBps * dt / 8);
+    for (auto& b : cls_) b.tokens = std::min(b.depth, b.tokens + b.rateBps * dt / 8);
+}
+
+// Media token pozitifken gider (borç bir sonraki pakete yansır). Diğer sınıflar paket
+// boyu kadar (kova daha sığsa dolu kova) token ister; böylece borçları media'yı en fazla
+// bir paketlik süre geciktirir.
+bool PacerTransport::canSend(int c, size_t len) const {
+    const Bucket& b = cls_[c];
+    if (c == (int)PaceClass::MEDIA)
+        return link_.tokens > 0 && (b.rateBps <= 0 || b.tokens > 0);
+    const double need = (double)len;
+    return link_.tokens >= std::min(need, link_.depth) &&
+           (b.rateBps <= 0 || b.tokens >= std::min(need, b.depth));
+}
+
+void PacerTransport::consume(int c, size_t len){
+    link_.tokens -= (double)len;
+    if (cls_[c].rateBps > 0) cls_[c].tokens -= (double)len;
+    sent_[c]++;
+}
+
+bool PacerTransport::send(const uint8_t* data, size_t len){
+    if (!pp_.enabled) return inner_->send(data, len);
+    const int c = (int)classify(data, len);
+
+    std::unique_lock<std::mutex> lk(mu_);
+    if (!running_) { lk.unlock(); return inner_->send(data, len); }
+    const uint64_t now = steadyNs();
+    refill(now);
+
+    // Kendi sınıfında ya da daha öncelikli sınıfta bekleyen yoksa ve token varsa hemen.
+    // Flush batch'i o an gönderiliyorsa sıra bozulmasın diye kuyruğa girer.
+    bool ahead = sending_;
+    for (int i=0;i<=c && !ahead;++i) ahead = !q_[i].empty();
+    if (!ahead && canSend(c, len)) {
+        consume(c, len);
+        lk.unlock();
+        return inner_->send(data, len);
+    }
+    if (sending_) deferred_ = true;
+
+    auto& q = q_[c];
+    if (q.size() >= std::max<size_t>(1, pp_.maxQueuePackets)) {
+        spare_.push_back(std::move(q.front().pkt));
+        q.pop_front(); backlog_--; dropped_[c]++;
+    }
+    Pending p;
+    p.enqNs = now;
+    if (!spare_.empty()) { p.pkt = std::move(spare_.back()); spare_.pop_back(); }
+    p.pkt.assign(data, data + len);
+    q.push_back(std::move(p));
+    queued_[c]++;
+    // Sadece boştan dolua geçişte uyandır; timer çalışırken yeni paket uyandırmaz
+    if (backlog_++ == 0) cv_.notify_one();
+    return true;
+}
+
+void PacerTransport::flush(uint64_t nowNs){
+    refill(nowNs);
+    for (int c=0;c<PACE_CLASSES;++c) {
+        auto& q = q_[c];
+        const int maxMs = c == (int)PaceClass::MEDIA ? pp_.mediaMaxDelayMs : pp_.maxDelayMs;
+        const uint64_t maxNs = (uint64_t)std::max(0, maxMs) * 1000000ull;
+        while (!q.empty() && nowNs - q.front().enqNs > maxNs) {
+            spare_.push_back(std::move(q.front().pkt));
+            q.pop_front(); backlog_--; dropped_[c]++;
+        }
+        // Sınıflar öncelik sırasıyla; bir sınıfın kova sınırı alttakileri durdurmaz,
+        // toplam kova ise zaten sırayla tükenir.
+        while (!q.empty() && canSend(c, q.front().pkt.size())) {
+            Pending& p = q.front();
+            consume(c, p.pkt.size());
+            maxWaitNs_ = std::max(maxWaitNs_, nowNs - p.enqNs);
+            batch_.push_back(std::move(p));
+            q.pop_front(); backlog_--;
+        }
+    }
+    flushes_++;
+}
+
+// batch_'i kilit dışında, sırasıyla gönderir; tamponlar geri dönüşüme girer.
+void PacerTransport::sendBatch(std::unique_lock<std::mutex>& lk){
+    if (batch_.empty()) return;
+    sending_ = true;
+    lk.unlock();
+    for (const Pending& p : batch_) inner_->send(p.pkt.data(), p.pkt.size());
+    lk.lock();
+    sending_ = false;
+    for (Pending& p : batch_) spare_.push_back(std::move(p.pkt));
+    batch_.clear();
+    if (spare_.size() > 64) spare_.resize(64);
+}
+
+void PacerTransport::flushLoop(){
+    using clock = std::chrono::steady_clock;
+    EventTracer::instance().setThreadName("pacer");
+    const auto period = std::chrono::milliseconds(std::max(1, pp_.flushMs));
+
+    std::unique_lock<std::mutex> lk(mu_);
+    auto next = clock::now() + period;
+    while (running_) {
+        if (!backlog_) {
+            cv_.wait(lk, [this]{ return !running_ || backlog_ > 0; });
+            next = clock::now() + period;
+            continue;
+        }
+        // Önceki batch gönderilirken kuyruğa alınan varsa periyodu beklemeden boşalt
+        if (!deferred_ && cv_.wait_until(lk, next, [this]{ return !running_; })) break;
+        if (!running_) break;
+        deferred_ = false;
+        flush(steadyNs());
+        sendBatch(lk);
+        const auto now = clock::now();
+        next += period;
+        if (next < now) next = now + period;   // uzun kesinti sonrası yakalamaya çalışma
+    }
+}
+
+PacerStats PacerTransport::stats(){
+    std::lock_guard<std::mutex> lk(mu_);
+    PacerStats st;
+    st.rateBps = rateBps_;
+    for (int c=0;c<PACE_CLASSES;++c) {
+        st.sent[c] = sent_[c]; st.queued[c] = queued_[c]; st.dropped[c] = dropped_[c];
+    }
+    st.backlog = backlog_;
+    st.maxWaitMs = maxWaitNs_ / 1e6;
+    st.flushes = flushes_;
+    maxWaitNs_ = 0;
+    return st;
+}
@@ -0,0 +1,97 @@
+#include "PacketTrace.hpp"
+#include <chrono>
+#include <iostream>
+
+// ---------- PacketTraceWriter ----------
+PacketTraceWriter::~PacketTraceWriter(){ close(); }
+
+uint64_t PacketTraceWriter::steadyNowNs(){
+    using namespace std::chrono;
+    return (uint64_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+uint64_t PacketTraceWriter::kernelToSteadyNs(uint64_t realtimeNs){
+    using namespace std::chrono;
+    int64_t rt = (int64_t)duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+    int64_t st = (int64_t)steadyNowNs();
+    return (uint64_t)((int64_t)realtimeNs + (st - rt));
+}
+
+bool PacketTraceWriter::open(const std::string& path){
+    std::lock_guard<std::mutex> lk(m_);
+    if (f_) return false;
+    f_ = std::fopen(path.c_str(), "wb");
+    if (!f_) { std::cerr << "[trace] cannot open " << path << "\n"; return false; }
+    std::setvbuf(f_, nullptr, _IOFBF, 1<<16);
+    PacketTraceFileHeader hdr{};
+    hdr.startNs = steadyNowNs();
+    std::fwrite(&hdr, sizeof(hdr), 1, f_);
+    records_ = 0;
+    return true;
+}
+
+void PacketTraceWriter::close(){
+    std::lock_guard<std::mutex> lk(m_);
+    if (f_) { std::fclose(f_); f_ = nullptr; }
+}
+
+void PacketTraceWriter::record(uint8_t dir, uint8_t clock, uint64_t tsNs,
+                               const uint8_t* data, size_t len){
+    if (len > 0xFFFF) return;
+    PacketTraceRecord rec{};
+    rec.tsNs = tsNs; rec.dir = dir; rec.clock = clock; rec.len = (uint16_t)len;
+    std::lock_guard<std::mutex> lk(m_);
+    if (!f_) return;
+    std::fwrite(&rec, sizeof(rec), 1, f_);
+    std::fwrite(data, 1, len, f_);
+    records_++;
+}
+
+// ---------- PacketTraceReader ----------
+PacketTraceReader::~PacketTraceReader(){ close(); }
+
+bool PacketTraceReader::open(const std::string& path){
+    close();
+    f_ = std::fopen(path.c_str(), "rb");
+    if (!f_) return false;
+    PacketTraceFileHeader ref{};
+    if (std::fread(&hdr_, sizeof(hdr_), 1, f_) != 1 || hdr_.magic != ref.magic || hdr_.version != ref.version) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void PacketTraceReader::close(){
+    if (f_) { std::fclose(f_); f_ = nullptr; }
+    hdr_ = PacketTraceFileHeader{};
+}
+
+bool PacketTraceReader::next(TracedPacket& out){
+    if (!f_) return false;
+    PacketTraceRecord rec{};
+    if (std::fread(&rec, sizeof(rec), 1, f_) != 1) return false;
+    out.tsNs = rec.tsNs; out.dir = rec.dir; out.clock = rec.clock;
+    out.data.resize(rec.len);
+    if (rec.len && std::fread(out.data.data(), 1, rec.len, f_) != rec.len) return false;
+    return true;
+}
+
+// ---------- TraceTransport ----------
+TraceTransport::TraceTransport(ITransport* inner, PacketTraceWriter* writer)
+: inner_(inner), w_(writer) {}
+
+bool TraceTransport::send(const uint8_t* data, size_t len){
+    w_->record(TRACE_DIR_TX, TRACE_CLOCK_STEADY, PacketTraceWriter::steadyNowNs(), data, len);
+    return inner_->send(data, len);
+}
+
+void TraceTransport::onReceive(RxHandler h){
+    rx_ = std::move(h);
+    inner_->onReceive([this](const uint8_t* d, size_t l){
+        uint64_t k = inner_->lastRxTimestampNs();
+        if (k) w_->record(TRACE_DIR_RX, TRACE_CLOCK_KERNEL, PacketTraceWriter::kernelToSteadyNs(k), d, l);
+        else   w_->record(TRACE_DIR_RX, TRACE_CLOCK_STEADY, PacketTraceWriter::steadyNowNs(), d, l);
+        if (rx_) rx_(d, l);
+    });
+}
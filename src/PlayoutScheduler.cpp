@@ -0,0 +1,43 @@
+#include "PlayoutScheduler.hpp"
+#include <algorithm>
+
+void PlayoutScheduler::configure(const PlayoutParams& pp, int sampleRate, int frameSamples, long capacity){
+    sampleRate_ = sampleRate;
+    frame_ = std::max(1, frameSamples);
+    capacity_ = std::max(0L, capacity);
+    // Cihaz tamponu hedeften küçükse hedefi tampona sığdır.
+    target_ = (long)pp.targetMs * sampleRate / 1000;
+    if (capacity_ > 0) target_ = std::min(target_, std::max<long>(frame_, capacity_ - frame_));
+    primed_ = false; inUnderrun_ = false;
+    queuedMs_ = 0; written_ = 0; underruns_ = 0;
+}
+
+int PlayoutScheduler::framesToWrite(long writeAvailable){
+    // Kuyruk bilinmiyorsa eski davranış: poll başına bir frame.
+    if (writeAvailable < 0 || capacity_ <= 0) return 1;
+
+    const long queued = std::max(0L, capacity_ - writeAvailable);
+    queuedMs_ = 1000.0 * queued / sampleRate_;
+
+    if (primed_ && queued == 0) {
+        if (!inUnderrun_) underruns_++;
+        inUnderrun_ = true;
+    } else if (queued > 0) {
+        inUnderrun_ = false;
+    }
+
+    if (queued >= target_) return 0;
+    long frames = (target_ - queued + frame_ - 1) / frame_;
+    frames = std::min(frames, writeAvailable / frame_);
+    if (frames > 0) primed_ = true;
+    return (int)frames;
+}
+
+PlayoutStats PlayoutScheduler::stats() const {
+    PlayoutStats st;
+    st.queuedMs = queuedMs_;
+    st.capacity = capacity_;
+    st.framesWritten = written_;
+    st.underruns = underruns_;
+    return st;
+}
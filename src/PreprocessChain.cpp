@@ -0,0 +1,159 @@
+#include "PreprocessChain.hpp"
+#include "FramePipeline.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+// ---------- SimpleVAD ----------
+void SimpleVAD::configure(float thRms, int hangMs, int sampleRate) {
+    thr_=thRms; hangSamples_=hangMs*sampleRate/1000;
+}
+bool SimpleVAD::isSpeech(const int16_t* pcm, int n, int) {
+    return decide(framekernels::rmsDynamic(pcm, n), n);
+}
+bool SimpleVAD::decide(float rms, int n) {
+    if (rms > thr_) { remain_ = hangSamples_; return true; }
+    if (remain_>0) { remain_ -= n; return true; }
+    return false;
+}
+
+// ---------- PreprocessChain ----------
+void PreprocessChain::clear(){
+    std::lock_guard<std::mutex> lk(m_);
+    stages_.clear();
+    timing_.clear();
+}
+
+void PreprocessChain::add(std::unique_ptr<IAudioStage> stage){
+    std::lock_guard<std::mutex> lk(m_);
+    stages_.push_back(std::move(stage));
+    timing_.push_back(std::make_unique<AtomicTiming>());
+}
+
+bool PreprocessChain::init(int sampleRate, int frameSamples){
+    std::lock_guard<std::mutex> lk(m_);
+    bool ok = true;
+    for (size_t i=0;i<stages_.size();) {
+        if (stages_[i]->init(sampleRate, frameSamples)) { ++i; continue; }
+        // açılamayan aşama zincirde kalırsa process'te yarım durumla çalışır
+        std::cerr << "[preproc] stage '" << stages_[i]->name() << "' init failed, skipped\n";
+        stages_.erase(stages_.begin() + i);
+        timing_.erase(timing_.begin() + i);
+        ok = false;
+    }
+    return ok;
+}
+
+void PreprocessChain::process(int16_t* pcm, int n, FrameContext& ctx){
+    using clock = std::chrono::steady_clock;
+    constexpr auto rlx = std::memory_order_relaxed;
+    for (size_t i=0;i<stages_.size();++i) {
+        auto t0 = clock::now();
+        stages_[i]->process(pcm, n, ctx);
+        double us = std::chrono::duration<double, std::micro>(clock::now() - t0).count();
+
+        AtomicTiming& t = *timing_[i];
+        const uint64_t frames = t.frames.load(rlx);
+        t.lastUs.store(us, rlx);
+        t.avgUs.store(frames ? 0.98 * t.avgUs.load(rlx) + 0.02 * us : us, rlx);
+        if (us > t.maxUs.load(rlx)) t.maxUs.store(us, rlx);
+        t.frames.store(frames + 1, rlx);
+    }
+}
+
+std::vector<PreprocessChain::StageTiming> PreprocessChain::timings() const {
+    constexpr auto rlx = std::memory_order_relaxed;
+    std::lock_guard<std::mutex> lk(m_);
+    std::vector<StageTiming> out(stages_.size());
+    for (size_t i=0;i<stages_.size();++i) {
+        out[i].name = stages_[i]->name();
+        out[i].lastUs = timing_[i]->lastUs.load(rlx);
+        out[i].avgUs = timing_[i]->avgUs.load(rlx);
+        out[i].maxUs = timing_[i]->maxUs.load(rlx);
+        out[i].frames = timing_[i]->frames.load(rlx);
+    }
+    return out;
+}
+
+// ---------- HighPassStage ----------
+bool HighPassStage::init(int sampleRate, int){
+    const float w0 = 2.0f * float(M_PI) * fc_ / float(sampleRate);
+    const float alpha = std::sin(w0) / (2.0f * 0.70710678f);
+    const float c = std::cos(w0);
+    const float a0 = 1.0f + alpha;
+    b0_ = (1.0f + c) / 2.0f / a0;
+    b1_ = -(1.0f + c) / a0;
+    b2_ = b0_;
+    a1_ = -2.0f * c / a0;
+    a2_ = (1.0f - alpha) / a0;
+    z1_ = z2_ = 0;
+    return fc_ > 0 && fc_ < sampleRate / 2;
+}
+
+void HighPassStage::process(int16_t* pcm, int n, FrameContext&){
+    // Direct form II transposed
+    float z1 = z1_, z2 = z2_;
+    for (int i=0;i<n;++i) {
+        const float x = pcm[i];
+        const float y = b0_*x + z1;
+        z1 = b1_*x - a1_*y + z2;
+        z2 = b2_*x - a2_*y;
+        pcm[i] = (int16_t)std::clamp(y, -32768.f, 32767.f);
+    }
+    z1_ = z1; z2_ = z2;
+}
+
+// ---------- AgcStage ----------
+void AgcStage::process(int16_t* pcm, int n, FrameContext&){
+    double e = 0;
+    for (int i=0;i<n;++i) e += double(pcm[i]) * pcm[i];
+    const float rms = (float)std::sqrt(e / std::max(1,n));
+
+    // Sessizlikte kazancı dondur; gürültüyü şişirmesin.
+    float target = gain_;
+    if (rms > 150.f) target = std::clamp(target_ / rms, 0.25f, maxGain_);
+    const float prev = gain_;
+    gain_ += (target < gain_ ? 0.3f : 0.03f) * (target - gain_); // hızlı atak, yavaş bırakma
+
+    // Frame boyunca doğrusal rampa (zipper gürültüsü olmasın) + doyma
+    const float step = (gain_ - prev) / std::max(1,n);
+    float g = prev;
+    for (int i=0;i<n;++i) {
+        g += step;
+        pcm[i] = (int16_t)std::clamp(pcm[i] * g, -32768.f, 32767.f);
+    }
+}
+
+// ---------- VadStage ----------
+bool VadStage::init(int sampleRate, int){
+    vad_.configure(th_, hangMs_, sampleRate);
+    return true;
+}
+
+void VadStage::process(int16_t* pcm, int n, FrameContext& ctx){
+    ctx.speech = (pipe_ && n == pipe_->frameSamples()) ? vad_.decide(pipe_->rms(pcm), n)
+                                                        : vad_.isSpeech(pcm, n, 0);
+}
+
+// ---------- buildPreprocessChain ----------
+void buildPreprocessChain(PreprocessChain& chain, const PreprocParams& pp, const FramePipeline* pipe){
+    chain.clear();
+    if (pp.highPass) chain.add(std::make_unique<HighPassStage>(pp.highPassHz));
+
+    PreprocParams::NsKind ns = pp.ns;
+    if (ns == PreprocParams::NS_AUTO)
+        ns = NoiseSuppressorSpeex::available() ? PreprocParams::NS_SPEEX : PreprocParams::NS_NATIVE;
+    if (ns == PreprocParams::NS_SPEEX && !NoiseSuppressorSpeex::available()) {
+        std::cerr << "[preproc] SpeexDSP not built in, using native NS\n";
+        ns = PreprocParams::NS_NATIVE;
+    }
+
+    if (ns == PreprocParams::NS_SPEEX) {
+        // Speex kendi AGC'sini yürütür
+        chain.add(std::make_unique<SpeexNsStage>(pp.nsDb, pp.agc, pp.agcTargetRms, pp.agcMaxGainDb));
+    } else {
+        if (ns == PreprocParams::NS_NATIVE) chain.add(std::make_unique<NativeNsStage>(pp.nsDb));
+        if (pp.agc) chain.add(std::make_unique<AgcStage>(pp.agcTargetRms, pp.agcMaxGainDb));
+    }
+    if (pp.vad) chain.add(std::make_unique<VadStage>(pp.vadRms, pp.vadHangMs, pipe));
+}
@@ -0,0 +1,213 @@
+#include "SessionHost.hpp"
+#include <arpa/inet.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+// ---------- Session ----------
+// Oturumun transport'u: gönderim paylaşımlı soketten, alım host'un demux'undan.
+struct SessionHost::Session : public ITransport {
+    SessionHost* host = nullptr;
+    uint32_t id = 0;        // slot
+    uint32_t token = 0;     // wheel/kuyruk kimliği (slot + nesil)
+    SessionConfig cfg;
+    sockaddr_in remote{};
+    RxHandler rx;
+
+    VoiceEngine engine;
+    uint64_t nextTick = 0;
+    uint64_t wheelExpiry = 0;   // wheelMu_ altında
+    bool removed = false;       // wheelMu_ altında
+    std::vector<int16_t> cap, play;
+
+    bool send(const uint8_t* data, size_t len) override {
+        return host->sock_.sendTo(id, data, len, remote);
+    }
+    void onReceive(RxHandler h) override { rx = std::move(h); }
+};
+
+// ---------- SessionHost ----------
+SessionHost::SessionHost(uint16_t localPort, int workers, int ioSockets)
+: sock_(localPort, ioSockets),
+  nWorkers_(workers > 0 ? workers : std::max(1u, std::thread::hardware_concurrency())),
+  t0_(std::chrono::steady_clock::now()) {}
+
+SessionHost::~SessionHost(){ stop(); }
+
+uint64_t SessionHost::nowTick() const {
+    using namespace std::chrono;
+    return (uint64_t)duration_cast<milliseconds>(steady_clock::now() - t0_).count();
+}
+
+bool SessionHost::start(){
+    if (running_) return true;
+    if (!sock_.start([this](const uint8_t* d, size_t l, const sockaddr_in& s){ onDatagram(d,l,s); }))
+        return false;
+    running_ = true;
+    timerTh_ = std::thread(&SessionHost::timerLoop, this);
+    for (int i=0;i<nWorkers_;++i) workers_.emplace_back(&SessionHost::workerLoop, this);
+    return true;
+}
+
+void SessionHost::stop(){
+    if (!running_) return;
+    running_ = false;
+    qCv_.notify_all();
+    if (timerTh_.joinable()) timerTh_.join();
+    for (auto& w : workers_) if (w.joinable()) w.join();
+    workers_.clear();
+    sock_.stop();
+}
+
+int SessionHost::addSession(SessionConfig cfg){
+    auto s = std::make_shared<Session>();
+    s->host = this;
+    s->remote.sin_family = AF_INET;
+    s->remote.sin_port = htons(cfg.remotePort);
+    if (inet_pton(AF_INET, cfg.remoteIp.c_str(), &s->remote.sin_addr) != 1) return -1;
+    s->cfg = std::move(cfg);
+    if (!s->engine.initHeadless(s->cfg.vp, s.get(), s->cfg.convId)) return -1;
+    s->engine.setBypassVad(s->cfg.bypassVad);
+    s->cap.resize(s->engine.frameSamples());
+
+    std::unique_lock<std::shared_mutex> lk(sessMu_);
+    if (byConv_.count(s->cfg.convId)) return -1;
+    // Boşalan slotlar yeniden kullanılır; sessions_ eşzamanlı oturum sayısı kadar kalır.
+    if (!freeSlots_.empty()) {
+        s->id = freeSlots_.back(); freeSlots_.pop_back();
+    } else {
+        if (sessions_.size() > SLOT_MASK) return -1;
+        s->id = (uint32_t)sessions_.size();
+        sessions_.emplace_back();
+        slotGen_.push_back(0);
+    }
+    const uint32_t gen = slotGen_[s->id] = (slotGen_[s->id] + 1) & (0xffffffffu >> SLOT_BITS);
+    s->token = s->id | (gen << SLOT_BITS);
+    sessions_[s->id] = s;
+    byConv_[s->cfg.convId] = s->id;
+    lk.unlock();
+
+    // Fazları dağıt: binlerce oturum aynı milisaniyede uyanmasın.
+    std::lock_guard<std::mutex> wl(wheelMu_);
+    s->nextTick = nowTick() + 1 + s->id % (uint32_t)std::max(1, s->cfg.vp.frameMs);
+    s->wheelExpiry = wheel_.schedule(s->token, s->nextTick);
+    return (int)s->id;
+}
+
+void SessionHost::removeSession(int id){
+    std::shared_ptr<Session> s;
+    {
+        std::unique_lock<std::shared_mutex> lk(sessMu_);
+        if (id < 0 || (size_t)id >= sessions_.size() || !sessions_[id]) return;
+        s = std::move(sessions_[id]);
+        byConv_.erase(s->cfg.convId);
+        freeSlots_.push_back((uint32_t)id);
+    }
+    // Wheel kaydını sil; o an çalışan tick yeniden planlamaz. Kuyruktaki kayıt
+    // nesli uyuşmadığı için workerLoop'ta atlanır.
+    std::lock_guard<std::mutex> wl(wheelMu_);
+    s->removed = true;
+    wheel_.cancel(s->token, s->wheelExpiry);
+}
+
+size_t SessionHost::sessionCount() const {
+    std::shared_lock<std::shared_mutex> lk(sessMu_);
+    return byConv_.size();
+}
+
+std::shared_ptr<SessionHost::Session> SessionHost::lookup(uint32_t token) const {
+    std::shared_lock<std::shared_mutex> lk(sessMu_);
+    const uint32_t slot = token & SLOT_MASK;
+    if (slot >= sessions_.size() || !sessions_[slot] || sessions_[slot]->token != token) return nullptr;
+    return sessions_[slot];
+}
+
+SessionHost::Stats SessionHost::stats() const {
+    Stats st;
+    st.ticks = ticks_; st.lateTicks = lateTicks_; st.maxLateMs = maxLateMs_;
+    std::shared_lock<std::shared_mutex> lk(sessMu_);
+    for (auto& s : sessions_) {
+        if (!s) continue;
+        st.txFrames += s->engine.txFrames();
+        st.rxFrames += s->engine.rxFrames();
+    }
+    return st;
+}
+
+void SessionHost::onDatagram(const uint8_t* data, size_t len, const sockaddr_in&){
+    if (len < sizeof(MeshVoiceHeader)) return;
+    MeshVoiceHeader hdr{};
+    std::memcpy(&hdr, data, sizeof(hdr));
+    std::shared_ptr<Session> s;
+    {
+        std::shared_lock<std::shared_mutex> lk(sessMu_);
+        auto it = byConv_.find(hdr.convId);
+        if (it == byConv_.end()) return;
+        s = sessions_[it->second];
+    }
+    if (s && s->rx) s->rx(data, len);
+}
+
+void SessionHost::timerLoop(){
+    std::vector<uint32_t> due;
+    uint64_t tick = nowTick();
+    while (running_) {
+        tick++;
+        std::this_thread::sleep_until(t0_ + std::chrono::milliseconds(tick));
+        due.clear();
+        {
+            std::lock_guard<std::mutex> wl(wheelMu_);
+            wheel_.advance(nowTick(), due);
+        }
+        if (due.empty()) continue;
+        {
+            std::lock_guard<std::mutex> ql(qMu_);
+            ready_.insert(ready_.end(), due.begin(), due.end());
+        }
+        if (due.size() == 1) qCv_.notify_one(); else qCv_.notify_all();
+    }
+}
+
+void SessionHost::workerLoop(){
+    constexpr size_t BATCH = 16;
+    std::vector<uint32_t> batch;
+    batch.reserve(BATCH);
+    while (running_) {
+        {
+            std::unique_lock<std::mutex> ql(qMu_);
+            qCv_.wait(ql, [this]{ return !ready_.empty() || !running_; });
+            while (!ready_.empty() && batch.size() < BATCH) { batch.push_back(ready_.front()); ready_.pop_front(); }
+        }
+        for (uint32_t token : batch) {
+            auto s = lookup(token);
+            if (s) runTick(*s);
+        }
+        batch.clear();
+    }
+}
+
+void SessionHost::runTick(Session& s){
+    const int frameMs = std::max(1, s.cfg.vp.frameMs);
+    uint64_t now = nowTick();
+    uint32_t late = now > s.nextTick ? (uint32_t)(now - s.nextTick) : 0;
+    ticks_++;
+    if (late > (uint32_t)frameMs) lateTicks_++;
+    uint32_t prevMax = maxLateMs_.load();
+    while (late > prevMax && !maxLateMs_.compare_exchange_weak(prevMax, late)) {}
+
+    // ---- TX
+    if (s.cfg.capture) {
+        s.cap.resize(s.engine.frameSamples());
+        if (s.cfg.capture(s.cap)) s.engine.sendFrame(s.cap);
+    }
+    // ---- RX
+    bool decoded = s.engine.playoutFrame(s.play);
+    if (s.cfg.playout) s.cfg.playout(s.play, decoded);
+
+    // Sabit ızgarada kal; çok geride kalındıysa kaçan tick'ler atlanır.
+    s.nextTick += frameMs;
+    while (s.nextTick <= now) s.nextTick += frameMs;
+    std::lock_guard<std::mutex> wl(wheelMu_);
+    if (s.removed) return;
+    s.wheelExpiry = wheel_.schedule(s.token, s.nextTick);
+}
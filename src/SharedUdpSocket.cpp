@@ -0,0 +1,114 @@
+#include "SharedUdpSocket.hpp"
+#include <arpa/inet.h>
+#include <netinet/ip.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cstdio>
+#include <cstring>
+
+SharedUdpSocket::SharedUdpSocket(uint16_t localPort, int sockets)
+: localPort_(localPort), nSockets_(sockets > 0 ? sockets : 1) {}
+
+int SharedUdpSocket::openSocket(){
+    int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) { perror("socket"); return -1; }
+
+    int rcv = 4<<20, snd = 4<<20; // binlerce oturum tek sokette: tampon büyük
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcv, sizeof(rcv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &snd, sizeof(snd));
+
+    int yes = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+#ifdef SO_REUSEPORT
+    setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &yes, sizeof(yes));
+#endif
+
+    int tos = 46 << 2; // DSCP EF -> TOS
+    setsockopt(fd, IPPROTO_IP, IP_TOS, &tos, sizeof(tos));
+
+    sockaddr_in local{};
+    local.sin_family      = AF_INET;
+    local.sin_port        = htons(localPort_);
+    local.sin_addr.s_addr = INADDR_ANY;
+    if (bind(fd, (sockaddr*)&local, sizeof(local)) < 0) {
+        perror("bind"); close(fd); return -1;
+    }
+
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags >= 0) fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    return fd;
+}
+
+bool SharedUdpSocket::start(RxHandler h){
+    if (running_) return true;
+    rx_ = std::move(h);
+    for (int i=0;i<nSockets_;++i) {
+        int fd = openSocket();
+        if (fd < 0) { stop(); return false; }
+        fds_.push_back(fd);
+    }
+    running_ = true;
+    for (int fd : fds_) threads_.emplace_back(&SharedUdpSocket::rxLoop, this, fd);
+    return true;
+}
+
+void SharedUdpSocket::stop(){
+    running_ = false;
+    for (auto& t : threads_) if (t.joinable()) t.join();
+    threads_.clear();
+    for (int fd : fds_) ::close(fd);
+    fds_.clear();
+}
+
+bool SharedUdpSocket::sendTo(size_t hint, const uint8_t* data, size_t len, const sockaddr_in& dst){
+    if (fds_.empty()) return false;
+    int fd = fds_[hint % fds_.size()];
+    ssize_t n = ::sendto(fd, data, len, 0, (const sockaddr*)&dst, sizeof(dst));
+    return n == (ssize_t)len;
+}
+
+void SharedUdpSocket::rxLoop(int fd){
+    constexpr size_t MAX = 2048;
+#if defined(__linux__)
+    // recvmmsg: tek syscall ile birden çok datagram
+    constexpr unsigned BATCH = 32;
+    std::vector<uint8_t> buf(BATCH * MAX);
+    sockaddr_in src[BATCH];
+    iovec iov[BATCH];
+    mmsghdr msgs[BATCH];
+#else
+    std::vector<uint8_t> buf(MAX);
+#endif
+
+    while (running_) {
+        fd_set rfds; FD_ZERO(&rfds); FD_SET(fd, &rfds);
+        timeval tv{0, 200*1000}; // 200ms
+        int r = select(fd+1, &rfds, nullptr, nullptr, &tv);
+        if (r <= 0) continue;
+
+#if defined(__linux__)
+        while (true) {
+            for (unsigned i=0;i<BATCH;++i) {
+                iov[i] = iovec{ buf.data() + i*MAX, MAX };
+                std::memset(&msgs[i], 0, sizeof(msgs[i]));
+                msgs[i].msg_hdr.msg_name = &src[i];
+                msgs[i].msg_hdr.msg_namelen = sizeof(src[i]);
+                msgs[i].msg_hdr.msg_iov = &iov[i];
+                msgs[i].msg_hdr.msg_iovlen = 1;
+            }
+            int n = recvmmsg(fd, msgs, BATCH, MSG_DONTWAIT, nullptr);
+            if (n <= 0) break;
+            for (int i=0;i<n;++i) {
+                if (rx_) rx_(buf.data() + i*MAX, msgs[i].msg_len, src[i]);
+            }
+            if (n < (int)BATCH) break;
+        }
+#else
+        sockaddr_in s{}; socklen_t sl = sizeof(s);
+        ssize_t n = recvfrom(fd, buf.data(), buf.size(), 0, (sockaddr*)&s, &sl);
+        if (n > 0 && rx_) rx_(buf.data(), (size_t)n, s);
+#endif
+    }
+}
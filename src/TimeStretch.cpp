@@ -0,0 +1,162 @@
+#include "TimeStretch.hpp"
+#include <algorithm>
+#include <cmath>
+
+// ---------- WsolaStretcher ----------
+void WsolaStretcher::configure(int sampleRate){
+    sampleRate_ = sampleRate;
+    L_   = std::max(16, sampleRate * 15 / 1000);  // 15 ms çıkış adımı
+    O_   = std::max(8,  sampleRate *  5 / 1000);  // 5 ms çapraz geçiş
+    tol_ = std::max(8,  sampleRate *  5 / 1000);  // ±5 ms arama
+    win_.resize((size_t)O_);
+    for (int i=0;i<O_;++i) win_[i] = 0.5f - 0.5f * std::cos(float(M_PI) * (i + 0.5f) / O_);
+    reset();
+}
+
+void WsolaStretcher::reset(){
+    in_.clear(); inBase_ = 0; nominal_ = 0; prevPos_ = -1;
+    tail_.assign((size_t)O_, 0.f);
+    out_.clear(); outRead_ = 0;
+    scaledMs_ = 0;
+}
+
+void WsolaStretcher::push(const int16_t* pcm, int n){
+    in_.insert(in_.end(), pcm, pcm + n);
+    while (step()) {}
+}
+
+int WsolaStretcher::pull(int16_t* out, int n){
+    const int k = std::min(n, available());
+    std::copy(out_.begin() + (long)outRead_, out_.begin() + (long)outRead_ + k, out);
+    outRead_ += (size_t)k;
+    if (outRead_ == out_.size()) { out_.clear(); outRead_ = 0; }
+    return k;
+}
+
+int WsolaStretcher::pendingInput() const {
+    const long long end = inBase_ + (long long)in_.size();
+    const long long from = std::max(inBase_, (long long)std::llround(nominal_));
+    return (int)std::max(0LL, end - from) + (prevPos_ >= 0 ? O_ : 0);
+}
+
+// [lo,hi] aralığında tail_ ile normalize çapraz korelasyonu en yüksek başlangıç.
+long long WsolaStretcher::bestOffset(long long lo, long long hi) const {
+    const float* x = in_.data() - inBase_;   // mutlak indeksle erişim
+    double e = 0;
+    for (int i=0;i<O_;++i) e += double(x[lo + i]) * x[lo + i];
+
+    long long best = lo;
+    double bestScore = -1e300;
+    for (long long c = lo; c <= hi; ++c) {
+        double num = 0;
+        for (int i=0;i<O_;++i) num += double(tail_[i]) * x[c + i];
+        const double score = num / std::sqrt(e + 1.0);
+        if (score > bestScore) { bestScore = score; best = c; }
+        // kayan pencere enerjisi
+        e += double(x[c + O_]) * x[c + O_] - double(x[c]) * x[c];
+    }
+    return best;
+}
+
+bool WsolaStretcher::step(){
+    const long long end = inBase_ + (long long)in_.size();
+    const long long n = std::llround(nominal_);
+    long long pos;
+
+    if (prevPos_ < 0) {
+        pos = std::max(n, inBase_);
+        if (pos + L_ + O_ > end) return false;
+    } else {
+        const long long natural = prevPos_ + L_;
+        // Doğal devam arama aralığındaysa korelasyonu zaten en yüksek olandır: birebir
+        // kopya, arama yok. Kayma ±tol'u aşınca bir pitch periyodu kadar atlanır/tekrarlanır.
+        if (std::llabs(natural - n) <= tol_) {
+            pos = natural;
+            if (pos + L_ + O_ > end) return false;
+        } else {
+            const long long lo = std::max(n - tol_, inBase_);
+            const long long hi = std::max(lo, n + tol_);
+            if (hi + L_ + O_ + 1 > end) return false;
+            pos = bestOffset(lo, hi);
+        }
+    }
+
+    const float* x = in_.data() + (pos - inBase_);
+    const size_t o = out_.size();
+    out_.resize(o + (size_t)L_);
+    int16_t* y = out_.data() + o;
+    for (int i=0;i<L_;++i) {
+        float v = x[i];
+        if (i < O_ && prevPos_ >= 0) v = tail_[i] + win_[i] * (x[i] - tail_[i]);
+        y[i] = (int16_t)std::clamp(v, -32768.f, 32767.f);
+    }
+    std::copy(x + L_, x + L_ + O_, tail_.begin());
+
+    // Nominal ilerleme L*rate; çıkış L. Fark atlanan/tekrarlanan süredir.
+    const double adv = prevPos_ < 0 ? L_ : L_ * rate_;
+    if (prevPos_ >= 0) scaledMs_ = scaledMs_ + 1000.0 * (adv - L_) / sampleRate_;
+    nominal_ = (prevPos_ < 0 ? (double)pos : nominal_) + adv;
+    prevPos_ = pos;
+
+    // Bir sonraki adımda gerekmeyecek girişi at
+    const long long keep = std::min(prevPos_ + L_, std::llround(nominal_) - tol_);
+    if (keep > inBase_) {
+        const long long drop = std::min(keep - inBase_, (long long)in_.size());
+        in_.erase(in_.begin(), in_.begin() + (long)drop);
+        inBase_ += drop;
+    }
+    return true;
+}
+
+// ---------- PlayoutRateController ----------
+void PlayoutRateController::configure(const TimeStretchParams& p, int frameMs){
+    p_ = p;
+    frameMs_ = std::max(1, frameMs);
+    filt_ = -1; drift_ = 0; wasGlitch_ = false;
+    target_ = std::min(p_.maxTargetMs, p_.minTargetMs + frameMs_);
+    rate_ = 1.0; driftPpm_ = 0; depthMs_ = 0; targetMs_ = target_;
+}
+
+double PlayoutRateController::update(double depthMs, bool starving, bool active){
+    // Hedef: her takılmada bir frame artış (spike boyunca değil, başında bir kez),
+    // temiz playout'ta ~2 dakikada bir frame azalış
+    const bool glitch = starving && active;
+    if (glitch && !wasGlitch_) target_ += frameMs_;
+    else if (!glitch)          target_ -= frameMs_ / 6000.0;
+    wasGlitch_ = glitch;
+    target_ = std::clamp(target_, (double)p_.minTargetMs, (double)std::max(p_.minTargetMs, p_.maxTargetMs));
+
+    // ~20 frame'lik ortalama; jitter buffer derinliği frame adımlarıyla değişir
+    filt_ = filt_ < 0 ? depthMs : filt_ + 0.05 * (depthMs - filt_);
+    const double err = filt_ - target_;
+
+    // P: yarım frame ölü bölge dışında, 100 ms fazlada tam hız
+    const double dead = 0.5 * frameMs_;
+    double pTerm = 0;
+    if (err > dead)       pTerm = (err - dead) * p_.maxSpeedup / 100.0;
+    else if (err < -dead) pTerm = (err + dead) * p_.maxSlowdown / 100.0;
+
+    // I: saat kayması. Kuyruk akarken, dakikalar mertebesinde öğrenilir; takılma/spike
+    // geçişleri (saniyeler) tahmini ancak birkaç ppm oynatır.
+    // Spike sonrası erime gibi büyük hatalar kaymaya yazılmaz (±2 frame içi).
+    if (!starving && active && std::fabs(err) <= 4 * dead) {
+        const double lim = p_.maxDriftPpm * 1e-6;
+        drift_ = std::clamp(drift_ + 1e-7 * err * frameMs_ / 1000.0, -lim, lim);
+    }
+
+    const double rate = std::clamp(1.0 + drift_ + pTerm, 1.0 - p_.maxSlowdown, 1.0 + p_.maxSpeedup);
+    rate_ = rate;
+    driftPpm_ = drift_ * 1e6;
+    depthMs_ = filt_;
+    targetMs_ = target_;
+    return rate;
+}
+
+TimeStretchStats PlayoutRateController::stats() const {
+    TimeStretchStats st;
+    st.rate = rate_;
+    st.driftPpm = driftPpm_;
+    st.depthMs = depthMs_;
+    st.targetMs = targetMs_;
+    return st;
+}
@@ -0,0 +1,65 @@
+#include "TimerWheel.hpp"
+
+uint64_t TimerWheel::schedule(uint32_t id, uint64_t expiryTick){
+    // geçmiş/şimdi: bir sonraki tick'te düşsün
+    if (expiryTick <= cur_) expiryTick = cur_ + 1;
+    place(Entry{ expiryTick, id });
+    count_++;
+    return expiryTick;
+}
+
+bool TimerWheel::cancel(uint32_t id, uint64_t expiryTick){
+    if (expiryTick <= cur_) return false; // zaten düştü
+    // Seviye indeksleri sadece süreye bağlı: cascade kaydı aynı formülle taşır.
+    std::vector<Entry>* slots[3] = {
+        &l0_[expiryTick & (L0_SIZE-1)],
+        &l1_[(expiryTick >> L0_BITS) & (L1_SIZE-1)],
+        &overflow_,
+    };
+    for (auto* v : slots) {
+        for (size_t i=0;i<v->size();++i) {
+            if ((*v)[i].id == id && (*v)[i].expiry == expiryTick) {
+                (*v)[i] = v->back();
+                v->pop_back();
+                count_--;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void TimerWheel::place(const Entry& e){
+    uint64_t delta = e.expiry - cur_;
+    if (delta < L0_SIZE) {
+        l0_[e.expiry & (L0_SIZE-1)].push_back(e);
+    } else if (delta < (L1_SIZE-1) * L0_SIZE) {
+        l1_[(e.expiry >> L0_BITS) & (L1_SIZE-1)].push_back(e);
+    } else {
+        overflow_.push_back(e);
+    }
+}
+
+void TimerWheel::cascade(std::vector<Entry>& slot, std::vector<uint32_t>& out){
+    scratch_.swap(slot);
+    for (const Entry& e : scratch_) {
+        if (e.expiry <= cur_) { out.push_back(e.id); count_--; }
+        else place(e);
+    }
+    scratch_.clear();
+}
+
+void TimerWheel::advance(uint64_t nowTick, std::vector<uint32_t>& out){
+    while (cur_ < nowTick) {
+        cur_++;
+        uint64_t idx0 = cur_ & (L0_SIZE-1);
+        if (idx0 == 0) {
+            // Seviye 1'in sıradaki slotu seviye 0'a iner; overflow da yeniden yerleşir.
+            cascade(l1_[(cur_ >> L0_BITS) & (L1_SIZE-1)], out);
+            if (!overflow_.empty()) cascade(overflow_, out);
+        }
+        std::vector<Entry>& slot = l0_[idx0];
+        if (slot.empty()) continue;
+        cascade(slot, out);
+    }
+}
@@ -1,13 +1,18 @@
 #include "UdpTransport.hpp"
+#include "EventTrace.hpp"
 #include <netinet/ip.h>
 #include <sys/select.h>
 #include <sys/time.h>
+#include <sys/uio.h>
+#include <ctime>
 #include <unistd.h>
 #include <fcntl.h>
 #include <cstring>
+#include <cstddef>
 #include <iostream>
 #include <chrono>
 #include <vector>
+#include <algorithm>
 
 static bool set_nonblock(int fd) {
     int flags = fcntl(fd, F_GETFL, 0);
@@ -15,6 +20,13 @@ static bool set_nonblock(int fd) {
     return fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
 }
 
+// Olay izi için datagramın MeshVoiceHeader seq'i (kısa/yabancı pakette 0).
+static uint16_t peekSeq(const uint8_t* data, size_t len) {
+    if (len < sizeof(MeshVoiceHeader)) return 0;
+    uint16_t seq; std::memcpy(&seq, data + offsetof(MeshVoiceHeader, seq), sizeof(seq));
+    return seq;
+}
+
 UdpTransport::UdpTransport(uint16_t localPort, const std::string& remoteIp, uint16_t remotePort)
 : localPort_(localPort) {
     std::memset(&remote_, 0, sizeof(remote_));
@@ -37,6 +49,20 @@ bool UdpTransport::openSocket(uint16_t localPort) {
     int tos = 46 << 2; // DSCP EF -> TOS
     setsockopt(fd_, IPPROTO_IP, IP_TOS, &tos, sizeof(tos));
 
+#ifdef IP_MULTICAST_ALL
+    // Sadece bu soketin katıldığı grupları al (aynı porttaki başka soketlerinkini değil)
+    int no = 0;
+    setsockopt(fd_, IPPROTO_IP, IP_MULTICAST_ALL, &no, sizeof(no));
+#endif
+
+#ifdef SO_TIMESTAMPNS
+    if (kernelTs_ && setsockopt(fd_, SOL_SOCKET, SO_TIMESTAMPNS, &yes, sizeof(yes)) < 0) {
+        perror("SO_TIMESTAMPNS"); kernelTs_ = false;
+    }
+#else
+    kernelTs_ = false;
+#endif
+
     sockaddr_in local{};
     local.sin_family      = AF_INET;
     local.sin_port        = htons(localPort);
@@ -47,9 +73,120 @@ bool UdpTransport::openSocket(uint16_t localPort) {
     }
 
     set_nonblock(fd_);
+    applyMulticastOptions();
+    return true;
+}
+
+// ---------- multicast ----------
+static bool parseIp(const std::string& s, in_addr& out) {
+    if (s.empty()) { out.s_addr = htonl(INADDR_ANY); return true; }
+    return inet_pton(AF_INET, s.c_str(), &out) == 1;
+}
+
+bool UdpTransport::applyMembership(const Membership& m, bool join) {
+    ip_mreq mreq{};
+    mreq.imr_multiaddr = m.group;
+    mreq.imr_interface = m.iface;
+    if (setsockopt(fd_, IPPROTO_IP, join ? IP_ADD_MEMBERSHIP : IP_DROP_MEMBERSHIP,
+                   &mreq, sizeof(mreq)) < 0) {
+        perror(join ? "IP_ADD_MEMBERSHIP" : "IP_DROP_MEMBERSHIP");
+        return false;
+    }
+    return true;
+}
+
+void UdpTransport::applyMulticastOptions() {
+    std::lock_guard<std::mutex> lk(mcMu_);
+    unsigned char ttl = (unsigned char)mcTtl_, loop = mcLoop_ ? 1 : 0;
+    setsockopt(fd_, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+    setsockopt(fd_, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+    if (mcIf_.s_addr != htonl(INADDR_ANY))
+        setsockopt(fd_, IPPROTO_IP, IP_MULTICAST_IF, &mcIf_, sizeof(mcIf_));
+    for (const auto& m : groups_) applyMembership(m, true);
+}
+
+bool UdpTransport::joinGroup(const std::string& group, const std::string& ifaceIp) {
+    Membership m;
+    if (!parseIp(group, m.group) || !IN_MULTICAST(ntohl(m.group.s_addr)) || !parseIp(ifaceIp, m.iface)) {
+        std::cerr << "[UdpTransport] invalid multicast group/iface: " << group << " " << ifaceIp << "\n";
+        return false;
+    }
+    std::lock_guard<std::mutex> lk(mcMu_);
+    for (const auto& g : groups_)
+        if (g.group.s_addr == m.group.s_addr && g.iface.s_addr == m.iface.s_addr) return true;
+    if (fd_ >= 0 && !applyMembership(m, true)) return false;
+    groups_.push_back(m);
+    dedup_ = true;
+    return true;
+}
+
+bool UdpTransport::leaveGroup(const std::string& group, const std::string& ifaceIp) {
+    Membership m;
+    if (!parseIp(group, m.group) || !parseIp(ifaceIp, m.iface)) return false;
+    std::lock_guard<std::mutex> lk(mcMu_);
+    auto it = std::find_if(groups_.begin(), groups_.end(), [&](const Membership& g){
+        return g.group.s_addr == m.group.s_addr && g.iface.s_addr == m.iface.s_addr; });
+    if (it == groups_.end()) return false;
+    if (fd_ >= 0) applyMembership(*it, false);
+    groups_.erase(it);
+    dedup_ = !groups_.empty();
+    return true;
+}
+
+bool UdpTransport::mapConvToGroup(uint32_t convId, const std::string& group, uint16_t port) {
+    sockaddr_in dst{};
+    dst.sin_family = AF_INET;
+    dst.sin_port = port ? htons(port) : remote_.sin_port;
+    if (!parseIp(group, dst.sin_addr) || !IN_MULTICAST(ntohl(dst.sin_addr.s_addr))) return false;
+    std::lock_guard<std::mutex> lk(mcMu_);
+    convGroups_[convId] = dst;
+    hasConvGroups_ = true;
+    return true;
+}
+
+void UdpTransport::unmapConv(uint32_t convId) {
+    std::lock_guard<std::mutex> lk(mcMu_);
+    convGroups_.erase(convId);
+    hasConvGroups_ = !convGroups_.empty();
+}
+
+void UdpTransport::setMulticastTtl(int ttl) {
+    std::lock_guard<std::mutex> lk(mcMu_);
+    mcTtl_ = std::clamp(ttl, 0, 255);
+    unsigned char v = (unsigned char)mcTtl_;
+    if (fd_ >= 0) setsockopt(fd_, IPPROTO_IP, IP_MULTICAST_TTL, &v, sizeof(v));
+}
+
+void UdpTransport::setMulticastLoopback(bool on) {
+    std::lock_guard<std::mutex> lk(mcMu_);
+    mcLoop_ = on;
+    unsigned char v = on ? 1 : 0;
+    if (fd_ >= 0) setsockopt(fd_, IPPROTO_IP, IP_MULTICAST_LOOP, &v, sizeof(v));
+}
+
+bool UdpTransport::setMulticastInterface(const std::string& ifaceIp) {
+    in_addr a{};
+    if (!parseIp(ifaceIp, a)) return false;
+    std::lock_guard<std::mutex> lk(mcMu_);
+    mcIf_ = a;
+    if (fd_ >= 0 && setsockopt(fd_, IPPROTO_IP, IP_MULTICAST_IF, &a, sizeof(a)) < 0) {
+        perror("IP_MULTICAST_IF"); return false;
+    }
     return true;
 }
 
+// Unicast ve multicast kopyaları bayt bayt aynıdır: FNV-1a özeti, direct-mapped tablo.
+// Çakışmada eski kayıt ezilir (geç gelen kopya geçer; jitter buffer aynı seq'i zaten ezer).
+bool UdpTransport::isDuplicate(const uint8_t* data, size_t len) {
+    uint64_t h = 1469598103934665603ull;
+    for (size_t i=0;i<len;++i) { h ^= data[i]; h *= 1099511628211ull; }
+    h |= 1; // 0 = boş slot
+    uint64_t& slot = seen_[(h >> 17) & (DEDUP_SLOTS - 1)];
+    if (slot == h) return true;
+    slot = h;
+    return false;
+}
+
 bool UdpTransport::start() {
     if (fd_ == -1 && !openSocket(localPort_)) return false;
     running_ = true;
@@ -69,7 +206,15 @@ bool UdpTransport::send(const uint8_t* data, size_t len) {
     if (len > 1400) {
         std::cerr << "[UdpTransport] WARNING: oversize UDP packet " << len << " bytes\n";
     }
-    ssize_t n = ::sendto(fd_, data, len, 0, (sockaddr*)&remote_, sizeof(remote_));
+    TraceSpan span(TraceEv::SEND, EventTracer::enabled() ? peekSeq(data, len) : 0, (uint32_t)len);
+    sockaddr_in dst = remote_;
+    if (hasConvGroups_ && len >= sizeof(MeshVoiceHeader)) {
+        uint32_t conv; std::memcpy(&conv, data + offsetof(MeshVoiceHeader, convId), sizeof(conv));
+        std::lock_guard<std::mutex> lk(mcMu_);
+        auto it = convGroups_.find(conv);
+        if (it != convGroups_.end()) dst = it->second;
+    }
+    ssize_t n = ::sendto(fd_, data, len, 0, (sockaddr*)&dst, sizeof(dst));
     return n == (ssize_t)len;
 }
 
@@ -83,6 +228,7 @@ void UdpTransport::rxLoop() {
     using namespace std::chrono_literals;
     constexpr size_t MAX = 2048;
     std::vector<uint8_t> buf(MAX);
+    EventTracer::instance().setThreadName("udp-rx");
 
     while (running_) {
         fd_set rfds; FD_ZERO(&rfds); FD_SET(fd_, &rfds);
@@ -91,9 +237,28 @@ void UdpTransport::rxLoop() {
         if (r <= 0) continue;
 
         if (FD_ISSET(fd_, &rfds)) {
-            sockaddr_in src{}; socklen_t sl = sizeof(src);
-            ssize_t n = recvfrom(fd_, buf.data(), buf.size(), 0, (sockaddr*)&src, &sl);
+            sockaddr_in src{};
+            iovec iov{ buf.data(), buf.size() };
+            alignas(cmsghdr) uint8_t ctrl[64];
+            msghdr msg{};
+            msg.msg_name = &src; msg.msg_namelen = sizeof(src);
+            msg.msg_iov = &iov; msg.msg_iovlen = 1;
+            msg.msg_control = kernelTs_ ? ctrl : nullptr;
+            msg.msg_controllen = kernelTs_ ? sizeof(ctrl) : 0;
+            ssize_t n = recvmsg(fd_, &msg, 0);
             if (n > 0) {
+                lastRxNs_ = 0;
+#ifdef SO_TIMESTAMPNS
+                for (cmsghdr* c = CMSG_FIRSTHDR(&msg); kernelTs_ && c; c = CMSG_NXTHDR(&msg, c)) {
+                    if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_TIMESTAMPNS) {
+                        timespec ts; std::memcpy(&ts, CMSG_DATA(c), sizeof(ts));
+                        lastRxNs_ = uint64_t(ts.tv_sec) * 1000000000ull + uint64_t(ts.tv_nsec);
+                    }
+                }
+#endif
+                if (dedup_ && isDuplicate(buf.data(), (size_t)n)) { dupDropped_++; continue; }
+                traceInstant(TraceEv::RECV, EventTracer::enabled() ? peekSeq(buf.data(), (size_t)n) : 0,
+                             (uint32_t)n);
                 if (rx_) rx_(buf.data(), (size_t)n);
             }
         }
@@ -1,4 +1,5 @@
 #include "VoiceEngine.hpp"
+#include "EventTrace.hpp"
 #include <portaudio.h>
 #include <opus/opus.h>
 #include <cstring>
@@ -10,79 +11,98 @@
 
 // ---------- AudioIO ----------
 namespace {
-struct PaState {
-    PaStream* in = nullptr;
-    PaStream* out = nullptr;
-    int sampleRate = 16000;
-    int channels = 1;
-    int frameSamples = 320; // 20ms @16k
-    int inIndex = -1;
-    int outIndex = -1;
-};
-PaState g;
+std::mutex paMutex;
+int paUsers = 0;
+}
+
+bool AudioIO::acquirePa(){
+    if (paRef_) return true;
+    std::lock_guard<std::mutex> lk(paMutex);
+    if (paUsers == 0 && Pa_Initialize() != paNoError) return false;
+    paUsers++; paRef_ = true;
+    return true;
 }
 
 void AudioIO::setPreferredDevices(int inIndex, int outIndex){
-    g.inIndex = inIndex;
-    g.outIndex = outIndex;
+    inIndex_ = inIndex;
+    outIndex_ = outIndex;
 }
 
-bool AudioIO::startCapture(int sampleRate, int channels) {
-    Pa_Initialize();
-    g.sampleRate = sampleRate; g.channels = channels;
-    g.frameSamples = frameSamples(sampleRate, 20);
+bool AudioIO::startCapture(int sampleRate, int channels, int frameMs) {
+    if (!acquirePa()) return false;
+    sampleRate_ = sampleRate; channels_ = channels;
+    frameSamples_ = frameSamples(sampleRate, frameMs);
 
     PaStreamParameters inParams{};
-    inParams.device = (g.inIndex >= 0 ? g.inIndex : Pa_GetDefaultInputDevice());
+    inParams.device = (inIndex_ >= 0 ? inIndex_ : Pa_GetDefaultInputDevice());
     inParams.channelCount = channels;
     inParams.sampleFormat = paInt16;
     inParams.suggestedLatency = 0.05;
 
-    if (Pa_OpenStream(&g.in, &inParams, nullptr, sampleRate, g.frameSamples,
+    PaStream* s = nullptr;
+    if (Pa_OpenStream(&s, &inParams, nullptr, sampleRate, frameSamples_,
                       paNoFlag, nullptr, nullptr) != paNoError) return false;
-    return Pa_StartStream(g.in) == paNoError;
+    in_ = s;
+    return Pa_StartStream(s) == paNoError;
 }
 
 bool AudioIO::startPlayback(int sampleRate, int channels) {
+    if (!acquirePa()) return false;
     PaStreamParameters outParams{};
-    outParams.device = (g.outIndex >= 0 ? g.outIndex : Pa_GetDefaultOutputDevice());
+    outParams.device = (outIndex_ >= 0 ? outIndex_ : Pa_GetDefaultOutputDevice());
     outParams.channelCount = channels;
     outParams.sampleFormat = paInt16;
     outParams.suggestedLatency = 0.05;
 
-    if (Pa_OpenStream(&g.out, nullptr, &outParams, sampleRate, g.frameSamples,
+    PaStream* s = nullptr;
+    if (Pa_OpenStream(&s, nullptr, &outParams, sampleRate, frameSamples_,
                       paNoFlag, nullptr, nullptr) != paNoError) return false;
-    return Pa_StartStream(g.out) == paNoError;
+    out_ = s;
+    if (Pa_StartStream(s) != paNoError) return false;
+    // Henüz yazılmadı: tampon boş, writeAvailable tam kapasite.
+    long cap = Pa_GetStreamWriteAvailable(s);
+    outCapacity_ = cap > 0 ? cap : 0;
+    return true;
 }
 
 bool AudioIO::readFrame(std::vector<int16_t>& outPcm) {
-    outPcm.resize(g.frameSamples);
-    PaError pe = Pa_ReadStream(g.in, outPcm.data(), g.frameSamples);
+    outPcm.resize(frameSamples_);
+    return readFrame(outPcm.data(), frameSamples_);
+}
+
+bool AudioIO::readFrame(int16_t* out, int samples) {
+    if (!in_) return false;
+    TraceSpan span(TraceEv::CAPTURE, capFrames_++, (uint32_t)samples);
+    PaError pe = Pa_ReadStream(in_, out, samples);
     if (pe == paNoError || pe == paInputOverflowed) return true;
     return false;
 }
 
 bool AudioIO::writeFrame(const std::vector<int16_t>& pcm) {
-    if (!g.out) return false;
-    return Pa_WriteStream(g.out, pcm.data(), pcm.size()) == paNoError;
+    return writeFrame(pcm.data(), pcm.size());
 }
 
-void AudioIO::stop() {
-    if (g.in) { Pa_StopStream(g.in); Pa_CloseStream(g.in); g.in=nullptr; }
-    if (g.out){ Pa_StopStream(g.out);Pa_CloseStream(g.out);g.out=nullptr; }
-    Pa_Terminate();
+bool AudioIO::writeFrame(const int16_t* pcm, size_t samples) {
+    if (!out_) return false;
+    TraceSpan span(TraceEv::PLAY, playFrames_++, (uint32_t)samples);
+    PaError pe = Pa_WriteStream(out_, pcm, samples);
+    return pe == paNoError || pe == paOutputUnderflowed; // underflow'u PlayoutScheduler sayar
 }
 
-// ---------- SimpleVAD ----------
-void SimpleVAD::configure(float thRms, int hangMs) {
-    thr_=thRms; hangSamples_=hangMs*16;
+long AudioIO::writeAvailable() const {
+    if (!out_) return -1;
+    long n = Pa_GetStreamWriteAvailable(out_);
+    return n >= 0 ? n : -1;
 }
-bool SimpleVAD::isSpeech(const int16_t* pcm, int n, int) {
-    double s=0; for (int i=0;i<n;i++){ s += double(pcm[i])*pcm[i]; }
-    float rms = std::sqrt(s / std::max(1,n));
-    if (rms > thr_) { remain_ = hangSamples_; return true; }
-    if (remain_>0) { remain_ -= n; return true; }
-    return false;
+
+void AudioIO::stop() {
+    if (in_) { Pa_StopStream(in_); Pa_CloseStream(in_); in_=nullptr; }
+    if (out_){ Pa_StopStream(out_);Pa_CloseStream(out_);out_=nullptr; outCapacity_=0; }
+    if (paRef_) {
+        std::lock_guard<std::mutex> lk(paMutex);
+        if (--paUsers == 0) Pa_Terminate();
+        paRef_ = false;
+    }
 }
 
 // ---------- OpusCodec ----------
@@ -91,7 +111,7 @@ bool OpusCodec::initEnc(int sampleRate, int bitrateBps, bool fec, bool dtx, int
     enc_ = opus_encoder_create(sampleRate, 1, OPUS_APPLICATION_VOIP, &err);
     if (err!=OPUS_OK) return false;
     opus_encoder_ctl(enc_, OPUS_SET_BITRATE(bitrateBps));
-    opus_encoder_ctl(enc_, OPUS_SET_COMPLEXITY(5));
+    opus_encoder_ctl(enc_, OPUS_SET_COMPLEXITY(5)); // governor açıksa initPipeline'da ezilir
     opus_encoder_ctl(enc_, OPUS_SET_SIGNAL(OPUS_SIGNAL_VOICE));
     opus_encoder_ctl(enc_, OPUS_SET_INBAND_FEC(fec?1:0));
     opus_encoder_ctl(enc_, OPUS_SET_DTX(dtx?1:0));
@@ -117,6 +137,19 @@ void OpusCodec::reconfigure(int bitrateBps, int fec, int lossPerc){
     opus_encoder_ctl(enc_, OPUS_SET_INBAND_FEC(fec?1:0));
     opus_encoder_ctl(enc_, OPUS_SET_PACKET_LOSS_PERC(lossPerc));
 }
+void OpusCodec::setComplexity(int complexity){
+    if (!enc_) return;
+    opus_encoder_ctl(enc_, OPUS_SET_COMPLEXITY(std::clamp(complexity, 0, 10)));
+}
+void OpusCodec::setMaxBandwidth(int bwLevel){
+    if (!enc_) return;
+    opus_encoder_ctl(enc_, OPUS_SET_MAX_BANDWIDTH(OPUS_BANDWIDTH_NARROWBAND + std::clamp(bwLevel, (int)BW_NARROW, (int)BW_FULL)));
+}
+int OpusCodec::lookahead() const {
+    opus_int32 v = 0;
+    if (!enc_ || opus_encoder_ctl(enc_, OPUS_GET_LOOKAHEAD(&v)) != OPUS_OK) return -1;
+    return (int)v;
+}
 OpusCodec::~OpusCodec(){
     if(enc_) opus_encoder_destroy(enc_);
     if(dec_) opus_decoder_destroy(dec_);
@@ -133,12 +166,14 @@ void JitterBuffer::push(uint16_t seq, std::vector<uint8_t> frame){
     int16_t d = diffSeq(seq, baseSeq_);
     if (d<0 || d >= (int16_t)window_.size()) return;
     window_[d] = std::move(frame);
+    traceInstant(TraceEv::JB_PUSH, seq, (uint32_t)d);
 }
 std::optional<EncodedFrame> JitterBuffer::popReady(){
     std::lock_guard<std::mutex> lk(m_);
     if (!baseSet_) return std::nullopt;
     if (window_[0].has_value()){
         EncodedFrame f{ baseSeq_, std::move(window_[0].value()) };
+        traceInstant(TraceEv::JB_POP, baseSeq_);
         for (size_t i=1;i<window_.size();++i) window_[i-1]=std::move(window_[i]);
         window_.back().reset();
         baseSeq_++;
@@ -146,6 +181,12 @@ std::optional<EncodedFrame> JitterBuffer::popReady(){
     }
     return std::nullopt;
 }
+size_t JitterBuffer::readyFrames(){
+    std::lock_guard<std::mutex> lk(m_);
+    size_t n = 0;
+    while (n < window_.size() && window_[n].has_value()) ++n;
+    return n;
+}
 
 // ---------- helpers ----------
 static uint32_t nowMs(){
@@ -160,18 +201,10 @@ void VoiceEngine::setDevices(int inIndex, int outIndex){
 
 bool VoiceEngine::init(const VoiceParams& vp, ITransport* tr, uint32_t convId){
     vp_=vp; tr_=tr; convId_=convId;
-    if (!audio_.startCapture(vp.sampleRate,1)) return false;
+    if (!audio_.startCapture(vp.sampleRate,1,vp.frameMs)) return false;
     if (!audio_.startPlayback(vp.sampleRate,1)) return false;
-
-    // FEC hep açık
-    if (!codec_.initEnc(vp.sampleRate, vp.bitrateBps, /*fec*/true, vp.opusDtx, vp.expectedLoss)) return false;
-    if (!codec_.initDec(vp.sampleRate)) return false;
-
-    int frameSamples = audio_.frameSamples(vp_.sampleRate, vp_.frameMs);
-    ns_.init(vp_.sampleRate, frameSamples, /*AGC*/true, /*NS dB*/-20);
-
-    vad_.configure(300.f, 150);
-    tr_->onReceive([this](const uint8_t* d, size_t l){ onRx(d,l); });
+    if (!initPipeline()) return false;
+    playout_.configure(vp_.playout, vp_.sampleRate, frameSamples(), audio_.outputCapacity());
 
     // Echo server istenmişse
     if (runEcho_) {
@@ -184,6 +217,42 @@ bool VoiceEngine::init(const VoiceParams& vp, ITransport* tr, uint32_t convId){
     return true;
 }
 
+bool VoiceEngine::initHeadless(const VoiceParams& vp, ITransport* tr, uint32_t convId){
+    vp_=vp; tr_=tr; convId_=convId;
+    return initPipeline();
+}
+
+bool VoiceEngine::initPipeline(){
+    pipe_.configure(vp_.sampleRate, vp_.frameMs);
+
+    // FEC hep açık
+    if (!codec_.initEnc(vp_.sampleRate, vp_.bitrateBps, /*fec*/true, vp_.opusDtx, vp_.expectedLoss)) return false;
+    if (!codec_.initDec(vp_.sampleRate)) return false;
+    gov_.configure(vp_.governor, vp_.frameMs, vp_.sampleRate);
+    if (vp_.governor.enabled) codec_.setComplexity(gov_.stats().complexity);
+
+    // NS/AGC/VAD zinciri; bir aşama açılamazsa zincir onsuz devam eder
+    buildPreprocessChain(pre_, vp_.preproc, &pipe_);
+    pre_.init(vp_.sampleRate, frameSamples());
+    initStretch();
+    tr_->onReceive([this](const uint8_t* d, size_t l){ onRx(d,l); });
+    announceRate(vp_.bitrateBps);
+    return true;
+}
+
+bool VoiceEngine::initReceiver(const VoiceParams& vp){
+    vp_=vp; tr_=nullptr;
+    gov_.configure(vp_.governor, vp_.frameMs, vp_.sampleRate);
+    initStretch();
+    return codec_.initDec(vp.sampleRate);
+}
+
+void VoiceEngine::initStretch(){
+    tsm_.configure(vp_.sampleRate);
+    rateCtl_.configure(vp_.stretch, vp_.frameMs);
+    decodeBuf_.assign((size_t)frameSamples(), 0);
+}
+
 void VoiceEngine::enableRttProbe(const std::string& remoteIp, uint16_t remoteEchoPort,
                                  const std::string& localIp, uint16_t localPort){
     if (rttProbe_) return;
@@ -200,59 +269,159 @@ void VoiceEngine::onRx(const uint8_t* data, size_t len){
     if (len < sizeof(MeshVoiceHeader)) return;
     MeshVoiceHeader hdr{};
     std::memcpy(&hdr, data, sizeof(hdr));
+    if (hdr.flags & (MVH_FLAG_PARITY | MVH_FLAG_FEC_REPORT)) return; // FEC katmanı tüketir
     if (hdr.payLen == 0 || len < sizeof(hdr)+hdr.payLen) return;
     const uint8_t* enc = data + sizeof(hdr);
     std::vector<uint8_t> frame(enc, enc + hdr.payLen);
     jb_.push(hdr.seq, std::move(frame));
+    rxPackets_++;
 }
 
-void VoiceEngine::pollOnce(){
-    uint32_t now = nowMs();
+bool VoiceEngine::playoutFrame(std::vector<int16_t>& outPcm){
+    int samples = frameSamples();
+    outPcm.resize((size_t)samples);
+    bool ok = playoutFrame(outPcm.data(), samples);
+    outPcm.resize((size_t)samples);
+    return ok;
+}
 
-    // ---- TX
-    std::vector<int16_t> pcm;
-    if (audio_.readFrame(pcm)) {
-        ns_.process(pcm.data(), (int)pcm.size());
-        bool speech = bypassVad_ ? true : vad_.isSpeech(pcm.data(), (int)pcm.size(), vp_.sampleRate);
-        if (speech) {
-            uint8_t encBuf[400];
-            size_t encLen = codec_.encode(pcm.data(), (int)pcm.size(), encBuf, sizeof(encBuf));
-            if (encLen>0) {
-                MeshVoiceHeader hdr{};
-                hdr.flags = 0b00000001; // PTT
-                hdr.seq = ++seq_;
-                hdr.convId = convId_;
-                hdr.tsMs = now;
-                hdr.payLen = (uint16_t)encLen;
-
-                std::vector<uint8_t> pkt(sizeof(hdr) + encLen);
-                std::memcpy(pkt.data(), &hdr, sizeof(hdr));
-                std::memcpy(pkt.data()+sizeof(hdr), encBuf, encLen);
-
-                if (localEcho_) { onRx(pkt.data(), pkt.size()); }
-                tr_->send(pkt.data(), pkt.size());
-                txFrames_++;
-            }
-        }
+bool VoiceEngine::playoutFrame(int16_t* out, int& samples){
+    if (!vp_.stretch.enabled) return decodeNext(out, samples);
+
+    // Son birkaç frame'de paket geldiyse akış sürüyor: buffer'ın boşalması takılmadır,
+    // konuşma arası değil.
+    const uint64_t rx = rxPackets_;
+    framesSinceRx_ = rx != seenRxPackets_ ? 0 : std::min(framesSinceRx_ + 1, 1 << 20);
+    seenRxPackets_ = rx;
+
+    // Hız: jitter buffer + stretch tamponundaki çalınabilir ses
+    const size_t jbFrames = jb_.readyFrames();
+    const double depthMs = double(jbFrames) * vp_.frameMs
+                         + 1000.0 * (tsm_.pendingInput() + tsm_.available()) / vp_.sampleRate;
+    double rate = rateCtl_.update(depthMs, jbFrames == 0, framesSinceRx_ <= 2);
+    if (jbFrames < 2) rate = std::min(rate, 1.0); // fazladan pop'u karşılayacak frame yok
+    tsm_.setRate(rate);
+
+    // Çıkış frame'i + bir WSOLA adımı birikene kadar decode et (hızlıyken frame başına
+    // 1'den fazla pop). Adım payı, çıkışın L granülünde büyümesinden doğan frame
+    // sınırı eksiklerini karşılar. Fazladan pop'ta frame yoksa concealment eklenmez.
+    const int n = samples;
+    const int reserve = n + tsm_.hop();
+    bool decoded = tsm_.available() >= n && lastDecoded_; // tampondan çıkan ses önceki decode'dan
+    for (int guard = 0; tsm_.available() < reserve && guard < 4; ++guard) {
+        if (guard > 0 && jb_.readyFrames() == 0) break;
+        int got = (int)decodeBuf_.size();
+        decoded |= decodeNext(decodeBuf_.data(), got);
+        tsm_.push(decodeBuf_.data(), got);
+    }
+    if (tsm_.available() < n) {
+        // Henüz bir frame yok (akış başı): yarım ses + sıfır yerine tüm frame concealment;
+        // biriken ses bir sonraki frame'e kalır.
+        std::fill(out, out + n, 0);
+        lastDecoded_ = false;
+        return false;
     }
+    tsm_.pull(out, n);
+    lastDecoded_ = decoded;
+    return decoded;
+}
 
-    // ---- RX
+bool VoiceEngine::decodeNext(int16_t* out, int& samples){
     auto ready = jb_.popReady();
     if (ready.has_value()) {
-        std::vector<int16_t> outPcm( audio_.frameSamples(vp_.sampleRate, vp_.frameMs) );
+        TraceSpan span(TraceEv::DECODE, ready->seq);
+        auto t0 = std::chrono::steady_clock::now();
         size_t ns = codec_.decode(ready->payload.data(), ready->payload.size(),
-                                  outPcm.data(), outPcm.size());
-        if (ns>0) { outPcm.resize(ns); audio_.writeFrame(outPcm); rxFrames_++; }
-        else { std::vector<int16_t> zeros(outPcm.size(), 0); audio_.writeFrame(zeros); }
+                                  out, (size_t)samples);
+        gov_.onDecode(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count());
+        span.setArg((uint32_t)ns);
+        if (ns>0) { samples = (int)ns; rxFrames_++; return true; }
+    } else {
+        traceInstant(TraceEv::CONCEAL, 0);
+    }
+    std::fill(out, out + samples, 0);
+    return false;
+}
+
+void VoiceEngine::sendFrame(std::vector<int16_t>& pcm){
+    sendFrame(pcm.data(), (int)pcm.size());
+}
+
+void VoiceEngine::sendFrame(int16_t* pcm, int n){
+    uint32_t now = nowMs();
+    FrameContext ctx;
+    {
+        TraceSpan span(TraceEv::PREPROC, (uint16_t)(seq_ + 1));
+        pre_.process(pcm, n, ctx);
+        span.setArg(ctx.speech ? 1 : 0);
+    }
+    bool speech = bypassVad_ ? true : ctx.speech;
+    if (speech) {
+        // header + payload doğrudan pipeline'ın paket tamponuna; frame başına allocation yok
+        uint8_t* pkt = pipe_.packetBuf();
+        size_t encLen = 0;
+        {
+            TraceSpan span(TraceEv::ENCODE, (uint16_t)(seq_ + 1));
+            auto t0 = std::chrono::steady_clock::now();
+            encLen = codec_.encode(pcm, n, pkt + sizeof(MeshVoiceHeader),
+                                   kMaxFramePacket - sizeof(MeshVoiceHeader));
+            gov_.onEncode(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count());
+            span.setArg((uint32_t)encLen);
+        }
+        if (encLen>0) {
+            MeshVoiceHeader hdr{};
+            hdr.flags = 0b00000001; // PTT
+            hdr.seq = ++seq_;
+            hdr.convId = convId_;
+            hdr.tsMs = now;
+            hdr.payLen = (uint16_t)encLen;
+            std::memcpy(pkt, &hdr, sizeof(hdr));
+
+            size_t pktLen = sizeof(hdr) + encLen;
+            if (localEcho_) { onRx(pkt, pktLen); }
+            tr_->send(pkt, pktLen);
+            txFrames_++;
+        }
     } else {
-        std::vector<int16_t> zeros( audio_.frameSamples(vp_.sampleRate, vp_.frameMs), 0 );
-        audio_.writeFrame(zeros);
+        gov_.onSilentFrame();
+    }
+    adaptBitrate(now);
+
+    // ---- CPU bütçesi: complexity / bant genişliği
+    int cx = 0, bw = 0;
+    if (gov_.update(cx, bw)) {
+        codec_.setComplexity(cx);
+        if (vp_.governor.adaptBandwidth) codec_.setMaxBandwidth(bw);
+    }
+}
+
+void VoiceEngine::pollOnce(){
+    pipe_.visit([this](auto& p){ pollFrame(p); });
+}
+
+// Somut pipeline tipiyle derlenir: Fixed varyantlarda n derleme zamanı sabiti.
+template<class Pipe>
+void VoiceEngine::pollFrame(Pipe& p){
+    const int n = p.frameSamples();
+
+    // ---- TX
+    int16_t* cap = p.captureBuf();
+    if (audio_.readFrame(cap, n)) sendFrame(cap, n);
+
+    // ---- RX: cihaz kuyruğunu hedef gecikmede tutacak kadar frame
+    int frames = playout_.framesToWrite(audio_.writeAvailable());
+    for (int f=0; f<frames; ++f) {
+        int16_t* out = p.playoutBuf();
+        int samples = n;
+        playoutFrame(out, samples);
+        if (audio_.writeFrame(out, (size_t)samples)) playout_.onFrameWritten();
     }
+}
 
+void VoiceEngine::adaptBitrate(uint32_t now){
     // ---- Basit ABR (RTT EWMA -> bitrate), FEC=1 sabit
-    static uint32_t lastAdapt=0;
-    if (rttProbe_ && now - lastAdapt >= 1000){
-        lastAdapt = now;
+    if (rttProbe_ && now - lastAdapt_ >= 1000){
+        lastAdapt_ = now;
         double rtt = rttProbe_->rttMs(); // <0 ise ölçülmedi
         if (rtt >= 0) {
             int target_bps;
@@ -262,11 +431,18 @@ void VoiceEngine::pollOnce(){
             else                 target_bps = 12000;
             int lossPerc = (rtt < 200 ? 5 : (rtt < 400 ? 10 : 20));
             codec_.reconfigure(target_bps, /*fec*/1, lossPerc);
+            announceRate(target_bps);
             // std::cout << "[ABR] rtt≈" << rtt << " ms -> " << target_bps << " bps (FEC=1, loss="<<lossPerc<<"%)\n";
         }
     }
 }
 
+void VoiceEngine::announceRate(int codecBps){
+    // codec hızı + frame başına MeshVoiceHeader
+    const int hdrBps = (int)(sizeof(MeshVoiceHeader) * 8 * 1000 / std::max(1, vp_.frameMs));
+    if (tr_) tr_->setSendRate(codecBps + hdrBps);
+}
+
 void VoiceEngine::shutdown(){
     if (rttProbe_) { rttProbe_->stop(); delete rttProbe_; rttProbe_=nullptr; }
     if (echoSrv_)  { echoSrv_->stop();  delete echoSrv_;  echoSrv_=nullptr;  }
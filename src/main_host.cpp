@@ -0,0 +1,69 @@
+#include "SessionHost.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+// Çok oturumlu host: N oturum, her biri kendi convId'si ile remote'a sentetik ton yollar.
+// İki host aynı --sessions/--conv-base ile karşılıklı çalıştırılarak yük testi yapılır.
+int main(int argc, char** argv){
+    if (argc < 4) {
+        std::cerr << "Kullanim: " << argv[0]
+                  << " <localPort> <remoteIp> <remotePort>"
+                  << " [--sessions N] [--workers W] [--io K] [--conv-base B] [--listen]\n";
+        return 1;
+    }
+    uint16_t localPort = (uint16_t)std::stoi(argv[1]);
+    std::string remoteIp = argv[2];
+    uint16_t remotePort = (uint16_t)std::stoi(argv[3]);
+
+    int sessions = 100, workers = 0, io = 1;
+    uint32_t convBase = 1000;
+    bool listenOnly = false;
+    for (int i=4;i<argc;i++){
+        if (std::strcmp(argv[i],"--sessions")==0 && i+1<argc) sessions = std::stoi(argv[++i]);
+        else if (std::strcmp(argv[i],"--workers")==0 && i+1<argc) workers = std::stoi(argv[++i]);
+        else if (std::strcmp(argv[i],"--io")==0 && i+1<argc) io = std::stoi(argv[++i]);
+        else if (std::strcmp(argv[i],"--conv-base")==0 && i+1<argc) convBase = (uint32_t)std::stoul(argv[++i]);
+        else if (std::strcmp(argv[i],"--listen")==0) listenOnly = true;
+    }
+
+    SessionHost host(localPort, workers, io);
+    if (!host.start()) { std::cerr << "host start failed\n"; return 1; }
+
+    for (int i=0;i<sessions;i++){
+        SessionConfig cfg;
+        cfg.convId = convBase + (uint32_t)i;
+        cfg.remoteIp = remoteIp;
+        cfg.remotePort = remotePort;
+        cfg.bypassVad = true;
+        if (!listenOnly) {
+            double hz = 200.0 + 10.0 * (i % 50);
+            auto phase = std::make_shared<double>(0.0);
+            int sr = cfg.vp.sampleRate;
+            cfg.capture = [hz, phase, sr](std::vector<int16_t>& pcm){
+                const double step = 2.0 * M_PI * hz / sr;
+                for (auto& s : pcm) { s = (int16_t)(3000.0 * std::sin(*phase)); *phase += step; }
+                *phase = std::fmod(*phase, 2.0 * M_PI);
+                return true;
+            };
+        }
+        if (host.addSession(std::move(cfg)) < 0) { std::cerr << "session " << i << " failed\n"; return 1; }
+    }
+
+    std::cout << "host: sessions=" << host.sessionCount() << " workers="
+              << (workers > 0 ? workers : (int)std::thread::hardware_concurrency())
+              << " io=" << io << "\n";
+
+    SessionHost::Stats last;
+    while (true) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        SessionHost::Stats st = host.stats();
+        std::cout << "[stats] ticks=+" << (st.ticks - last.ticks)
+                  << " TX=+" << (st.txFrames - last.txFrames)
+                  << " RX=+" << (st.rxFrames - last.rxFrames)
+                  << " late=" << st.lateTicks << " maxLate=" << st.maxLateMs << "ms\n";
+        last = st;
+    }
+}
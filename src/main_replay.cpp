@@ -0,0 +1,144 @@
+#include "VoiceEngine.hpp"
+#include "PacketFec.hpp"
+#include "PacketTrace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Basit mono 16-bit WAV yazıcı; header sonda boyutlarla yeniden yazılır.
+static void writeWavHeader(std::FILE* f, int sampleRate, uint32_t dataBytes){
+    auto put32=[&](uint32_t v){ std::fwrite(&v,4,1,f); };
+    auto put16=[&](uint16_t v){ std::fwrite(&v,2,1,f); };
+    std::fwrite("RIFF",1,4,f); put32(36 + dataBytes);
+    std::fwrite("WAVEfmt ",1,8,f); put32(16);
+    put16(1); put16(1); put32((uint32_t)sampleRate); put32((uint32_t)sampleRate*2);
+    put16(2); put16(16);
+    std::fwrite("data",1,4,f); put32(dataBytes);
+}
+
+// Trace'ten beslenen transport: kayıttaki datagramlar FEC katmanına verilir, FEC'in
+// gönderdiği alıcı raporları atılır.
+struct ReplaySource : ITransport {
+    RxHandler rx;
+    bool send(const uint8_t*, size_t) override { return true; }
+    void onReceive(RxHandler h) override { rx = std::move(h); }
+    void deliver(const uint8_t* data, size_t len) { if (rx) rx(data, len); }
+};
+
+int main(int argc, char** argv){
+    if (argc < 2) {
+        std::cerr << "Kullanim: " << argv[0]
+                  << " <trace.lmpt> [--realtime] [--sr HZ] [--frame-ms MS] [--conv ID] [--wav OUT]"
+                  << " [--no-tsm] [--jb-min MS] [--no-fec]\n";
+        return 1;
+    }
+    std::string tracePath = argv[1];
+    bool realtime = false;
+    std::string wavPath;
+    VoiceParams vp;
+    long convFilter = -1;
+    bool fecOn = true;
+
+    for (int i=2;i<argc;i++){
+        if (std::strcmp(argv[i],"--realtime")==0) realtime = true;
+        else if (std::strcmp(argv[i],"--sr")==0 && i+1<argc) vp.sampleRate = std::stoi(argv[++i]);
+        else if (std::strcmp(argv[i],"--frame-ms")==0 && i+1<argc) vp.frameMs = std::stoi(argv[++i]);
+        else if (std::strcmp(argv[i],"--conv")==0 && i+1<argc) convFilter = std::stol(argv[++i]);
+        else if (std::strcmp(argv[i],"--wav")==0 && i+1<argc) wavPath = argv[++i];
+        else if (std::strcmp(argv[i],"--no-tsm")==0) vp.stretch.enabled = false;
+        else if (std::strcmp(argv[i],"--jb-min")==0 && i+1<argc) vp.stretch.minTargetMs = std::stoi(argv[++i]);
+        else if (std::strcmp(argv[i],"--no-fec")==0) fecOn = false;
+    }
+
+    // ---- trace'i yükle (sadece RX, varış zamanına göre sıralı)
+    PacketTraceReader rd;
+    if (!rd.open(tracePath)) { std::cerr << "trace open failed: " << tracePath << "\n"; return 1; }
+    std::vector<TracedPacket> pkts;
+    TracedPacket tp;
+    while (rd.next(tp)) {
+        if (tp.dir != TRACE_DIR_RX) continue;
+        if (convFilter >= 0) {
+            if (tp.data.size() < sizeof(MeshVoiceHeader)) continue;
+            MeshVoiceHeader h{}; std::memcpy(&h, tp.data.data(), sizeof(h));
+            if (h.convId != (uint32_t)convFilter) continue;
+        }
+        pkts.push_back(std::move(tp));
+    }
+    std::stable_sort(pkts.begin(), pkts.end(),
+                     [](const TracedPacket& a, const TracedPacket& b){ return a.tsNs < b.tsNs; });
+    if (pkts.empty()) { std::cerr << "trace has no RX packets\n"; return 1; }
+
+    VoiceEngine ve;
+    if (!ve.initReceiver(vp)) { std::cerr << "decoder init failed\n"; return 1; }
+
+    // Canlı alım yoluyla aynı: UDP -> FEC -> engine. Parity başlıkları k/m/derinliği
+    // taşıdığından kaydın gönderici ayarları gerekmez; parity yoksa FEC şeffaftır.
+    ReplaySource src;
+    FecParams fp;
+    fp.frameMs = vp.frameMs;
+    std::unique_ptr<FecTransport> fec;
+    if (fecOn) {
+        fec = std::make_unique<FecTransport>(&src, fp);
+        fec->onReceive([&ve](const uint8_t* d, size_t l){ ve.ingest(d, l); });
+    } else {
+        src.onReceive([&ve](const uint8_t* d, size_t l){ ve.ingest(d, l); });
+    }
+
+    std::FILE* wav = nullptr;
+    uint32_t wavBytes = 0;
+    if (!wavPath.empty()) {
+        wav = std::fopen(wavPath.c_str(), "wb");
+        if (!wav) { std::cerr << "cannot open " << wavPath << "\n"; return 1; }
+        writeWavHeader(wav, vp.sampleRate, 0);
+    }
+
+    // ---- sanal saat: her frameMs'de bir, o ana kadar gelmiş paketleri ver ve playout üret
+    const uint64_t frameNs = uint64_t(vp.frameMs) * 1000000ull;
+    const uint64_t t0 = pkts.front().tsNs;
+    uint64_t tick = t0;
+    size_t next = 0;
+    uint64_t frames = 0, decoded = 0, concealed = 0;
+    std::vector<int16_t> pcm;
+
+    auto wall0 = std::chrono::steady_clock::now();
+    while (true) {
+        tick += frameNs;
+        while (next < pkts.size() && pkts[next].tsNs <= tick) {
+            src.deliver(pkts[next].data.data(), pkts[next].data.size());
+            next++;
+        }
+        if (realtime) std::this_thread::sleep_until(wall0 + std::chrono::nanoseconds(tick - t0));
+
+        bool ok = ve.playoutFrame(pcm);
+        if (!ok && next >= pkts.size()) break; // trace bitti, buffer boşaldı
+        frames++;
+        if (ok) decoded++; else concealed++;
+        if (wav) { std::fwrite(pcm.data(), sizeof(int16_t), pcm.size(), wav); wavBytes += (uint32_t)(pcm.size()*sizeof(int16_t)); }
+    }
+    double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wall0).count();
+
+    if (wav) { std::fseek(wav, 0, SEEK_SET); writeWavHeader(wav, vp.sampleRate, wavBytes); std::fclose(wav); }
+
+    double audioMs = double(frames) * vp.frameMs;
+    std::cout << "[replay] packets=" << pkts.size() << " frames=" << frames
+              << " decoded=" << decoded << " concealed=" << concealed << "\n"
+              << "[replay] audio=" << audioMs << "ms wall=" << wallMs << "ms"
+              << " speed=" << (wallMs > 0 ? audioMs / wallMs : 0.0) << "x\n";
+    if (fec) {
+        FecStats fs = fec->stats();
+        std::cout << "[replay] fec recovered=" << fs.recovered << " late=" << fs.recoveredLate
+                  << " unrecoverable=" << fs.unrecoverable << "\n";
+    }
+    if (vp.stretch.enabled) {
+        TimeStretchStats ts = ve.stretchStats();
+        std::cout << "[replay] tsm rate=" << ts.rate << " drift=" << (int)ts.driftPpm << "ppm"
+                  << " depth=" << (int)ts.depthMs << "/" << (int)ts.targetMs << "ms net=" << (int)ts.netMs << "ms\n";
+    }
+    return 0;
+}
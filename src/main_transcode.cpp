@@ -0,0 +1,101 @@
+#include "BatchTranscoder.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Toplu WAV -> Ogg/Opus (veya ham paket akışı). Dizin verilirse içindeki .wav dosyaları alınır.
+int main(int argc, char** argv){
+    if (argc < 2) {
+        std::cerr << "Kullanim: " << argv[0]
+                  << " <in.wav|dir>... [-o DIR] [--raw] [--threads N] [--chunk-sec S] [--overlap-sec S]"
+                  << " [--bitrate BPS] [--frame-ms MS] [--complexity N]"
+                  << " [--ns native|speex|off] [--no-agc] [--hpf]\n";
+        return 1;
+    }
+    TranscodeParams tp;
+    std::string outDir;
+    std::vector<std::string> args;
+
+    for (int i=1;i<argc;i++){
+        if (std::strcmp(argv[i],"-o")==0 && i+1<argc) outDir = argv[++i];
+        else if (std::strcmp(argv[i],"--raw")==0) tp.format = TranscodeParams::RAW;
+        else if (std::strcmp(argv[i],"--threads")==0 && i+1<argc) tp.threads = std::stoi(argv[++i]);
+        else if (std::strcmp(argv[i],"--chunk-sec")==0 && i+1<argc) tp.chunkSec = std::stod(argv[++i]);
+        else if (std::strcmp(argv[i],"--overlap-sec")==0 && i+1<argc) tp.overlapSec = std::stod(argv[++i]);
+        else if (std::strcmp(argv[i],"--bitrate")==0 && i+1<argc) tp.voice.bitrateBps = std::stoi(argv[++i]);
+        else if (std::strcmp(argv[i],"--frame-ms")==0 && i+1<argc) {
+            const double ms = std::stod(argv[++i]);
+            if (ms != (int)ms || !TranscodeParams::validFrameMs((int)ms)) {
+                std::cerr << "--frame-ms " << argv[i] << ": Opus frame must be 5, 10, 20, 40 or 60 ms"
+                          << (ms == 2.5 ? " (2.5 ms is not supported by this tool)" : "") << "\n";
+                return 1;
+            }
+            tp.voice.frameMs = (int)ms;
+        }
+        else if (std::strcmp(argv[i],"--complexity")==0 && i+1<argc) tp.complexity = std::stoi(argv[++i]);
+        else if (std::strcmp(argv[i],"--ns")==0 && i+1<argc) {
+            std::string k = argv[++i];
+            tp.voice.preproc.ns = k=="native" ? PreprocParams::NS_NATIVE : k=="speex" ? PreprocParams::NS_SPEEX
+                                : k=="off" ? PreprocParams::NS_OFF : PreprocParams::NS_AUTO;
+        }
+        else if (std::strcmp(argv[i],"--no-agc")==0) tp.voice.preproc.agc = false;
+        else if (std::strcmp(argv[i],"--hpf")==0) tp.voice.preproc.highPass = true;
+        else args.push_back(argv[i]);
+    }
+
+    // dizinler: içindeki .wav dosyaları (alfabetik)
+    std::vector<std::string> inputs;
+    for (const auto& a : args) {
+        std::error_code ec;
+        if (std::filesystem::is_directory(a, ec)) {
+            std::vector<std::string> found;
+            for (const auto& e : std::filesystem::directory_iterator(a, ec)) {
+                std::string ext = e.path().extension().string();
+                std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c){ return (char)std::tolower(c); });
+                if (e.is_regular_file() && ext == ".wav") found.push_back(e.path().string());
+            }
+            std::sort(found.begin(), found.end());
+            inputs.insert(inputs.end(), found.begin(), found.end());
+        } else {
+            inputs.push_back(a);
+        }
+    }
+    if (inputs.empty()) { std::cerr << "no input files\n"; return 1; }
+    if (!outDir.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(outDir, ec);
+    }
+
+    const int threads = tp.threads > 0 ? tp.threads : (int)std::thread::hardware_concurrency();
+    std::cout << "transcode: " << inputs.size() << " dosya, " << threads << " thread, "
+              << tp.voice.bitrateBps/1000 << " kbps, " << tp.voice.frameMs << " ms, cx=" << tp.complexity
+              << (tp.format == TranscodeParams::RAW ? ", raw" : ", ogg") << "\n";
+
+    BatchTranscoder bt(tp);
+    const auto t0 = std::chrono::steady_clock::now();
+    auto results = bt.run(inputs, outDir, [](const TranscodeResult& r){
+        if (!r.ok) { std::cout << "[fail] " << r.input << ": " << r.error << "\n"; return; }
+        const double kbps = r.audioSec > 0 ? r.bytes * 8 / r.audioSec / 1000 : 0;
+        std::cout << "[ok] " << r.input << " -> " << r.output << "  " << r.audioSec << " s, "
+                  << r.chunks << " parça, " << r.packets << " paket, " << kbps << " kbps, RTF="
+                  << r.rtf() << "\n";
+    });
+    const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    double audio = 0, cpu = 0;
+    int ok = 0;
+    for (const auto& r : results) if (r.ok) { audio += r.audioSec; cpu += r.cpuSec; ok++; }
+    // RTF: işlem süresi / ses süresi (<1 gerçek zamandan hızlı). Toplam: duvar saati.
+    std::cout << "[done] " << ok << "/" << results.size() << " dosya, " << audio << " s ses, "
+              << wall << " s";
+    if (audio > 0)
+        std::cout << ", RTF=" << wall / audio << " (x" << (wall > 0 ? audio / wall : 0) << " gerçek zaman)"
+                  << ", çekirdek RTF=" << cpu / audio;
+    std::cout << "\n";
+    return ok == (int)results.size() ? 0 : 1;
+}
@@ -1,9 +1,16 @@
 #include "VoiceEngine.hpp"
 #include "UdpTransport.hpp"
+#include "PacketTrace.hpp"
+#include "PacketFec.hpp"
+#include "PacketPacer.hpp"
+#include "EventTrace.hpp"
 #include <iostream>
 #include <thread>
 #include <chrono>
 #include <cstring>
+#include <memory>
+#include <atomic>
+#include <csignal>
 #include <portaudio.h>
 
 static void listDevices() {
@@ -22,11 +29,23 @@ static void listDevices() {
     Pa_Terminate();
 }
 
+// --trace-events: SIGUSR1 anlık dump alır. SIGINT/SIGTERM döngüden çıkar; izler
+// (--trace-out tamponu, --trace-events dump'ı) kapanışta dosyaya yazılır.
+static std::atomic<bool> gDumpReq{false}, gStopReq{false};
+static void onSignal(int sig){ (sig == SIGUSR1 ? gDumpReq : gStopReq) = true; }
+
 int main(int argc, char** argv){
     if (argc < 4) {
         std::cerr << "Kullanim: " << argv[0]
                   << " <localPort> <remoteIp> <remotePort> [echo] [bypass]"
-                  << " [--list] [--in N] [--out M] [--echo-port P] [--rtt IP:PORT]\n";
+                  << " [--list] [--in N] [--out M] [--echo-port P] [--rtt IP:PORT]"
+                  << " [--trace-out FILE] [--cpu-budget US] [--no-governor] [--govern-bw]"
+                  << " [--ns native|speex|off] [--no-agc] [--hpf] [--pre-stats]"
+                  << " [--play-target MS]"
+                  << " [--fec off|xor|rs|auto] [--fec-k N] [--fec-m N] [--fec-depth D]"
+                  << " [--trace-events FILE] [--no-tsm] [--jb-min MS]"
+                  << " [--mcast GROUP[:PORT]] [--mcast-if IP] [--mcast-ttl N] [--mcast-loop]"
+                  << " [--pace] [--pace-factor X] [--pace-ms MS]\n";
         return 1;
     }
     // zorunlu argümanlar
@@ -39,6 +58,21 @@ int main(int argc, char** argv){
     int inIdx = -1, outIdx = -1;
     uint16_t echoPort = 0;
     std::string rttTarget;
+    std::string traceOut;
+    std::string traceEvents;
+    double cpuBudgetUs = 0;
+    bool governor = true, governBw = false;
+    PreprocParams pp;
+    bool preStats = false;
+    PlayoutParams playout;
+    TimeStretchParams stretch;
+    std::string mcastGroup, mcastIf;
+    uint16_t mcastPort = 0;
+    int mcastTtl = 1;
+    bool mcastLoop = false;
+    FecParams fec;   // varsayılan: auto (kayıp raporu gelince devreye girer)
+    PacerParams pace;
+    pace.enabled = false;
 
     for (int i=4;i<argc;i++){
         if (std::strcmp(argv[i],"echo")==0) echo = true;
@@ -48,17 +82,105 @@ int main(int argc, char** argv){
         else if (std::strcmp(argv[i],"--out")==0 && i+1<argc) outIdx = std::stoi(argv[++i]);
         else if (std::strcmp(argv[i],"--echo-port")==0 && i+1<argc) echoPort = (uint16_t)std::stoi(argv[++i]);
         else if (std::strcmp(argv[i],"--rtt")==0 && i+1<argc) rttTarget = argv[++i];
+        else if (std::strcmp(argv[i],"--trace-out")==0 && i+1<argc) traceOut = argv[++i];
+        else if (std::strcmp(argv[i],"--trace-events")==0 && i+1<argc) traceEvents = argv[++i];
+        else if (std::strcmp(argv[i],"--cpu-budget")==0 && i+1<argc) cpuBudgetUs = std::stod(argv[++i]);
+        else if (std::strcmp(argv[i],"--no-governor")==0) governor = false;
+        else if (std::strcmp(argv[i],"--govern-bw")==0) governBw = true;
+        else if (std::strcmp(argv[i],"--ns")==0 && i+1<argc) {
+            std::string k = argv[++i];
+            pp.ns = k=="native" ? PreprocParams::NS_NATIVE : k=="speex" ? PreprocParams::NS_SPEEX
+                  : k=="off" ? PreprocParams::NS_OFF : PreprocParams::NS_AUTO;
+        }
+        else if (std::strcmp(argv[i],"--no-agc")==0) pp.agc = false;
+        else if (std::strcmp(argv[i],"--hpf")==0) pp.highPass = true;
+        else if (std::strcmp(argv[i],"--pre-stats")==0) preStats = true;
+        else if (std::strcmp(argv[i],"--play-target")==0 && i+1<argc) playout.targetMs = std::stoi(argv[++i]);
+        else if (std::strcmp(argv[i],"--fec")==0 && i+1<argc) {
+            std::string k = argv[++i];
+            fec.enabled  = k != "off";
+            fec.adaptive = k == "auto";
+            fec.coding   = k == "rs" ? FecParams::RS : FecParams::XOR;
+        }
+        else if (std::strcmp(argv[i],"--fec-k")==0 && i+1<argc) fec.k = std::stoi(argv[++i]);
+        else if (std::strcmp(argv[i],"--fec-m")==0 && i+1<argc) fec.m = std::stoi(argv[++i]);
+        else if (std::strcmp(argv[i],"--fec-depth")==0 && i+1<argc) fec.interleave = std::stoi(argv[++i]);
+        else if (std::strcmp(argv[i],"--no-tsm")==0) stretch.enabled = false;
+        else if (std::strcmp(argv[i],"--jb-min")==0 && i+1<argc) stretch.minTargetMs = std::stoi(argv[++i]);
+        else if (std::strcmp(argv[i],"--mcast")==0 && i+1<argc) {
+            mcastGroup = argv[++i];
+            auto pos = mcastGroup.find(':');
+            if (pos != std::string::npos) {
+                mcastPort = (uint16_t)std::stoi(mcastGroup.substr(pos+1));
+                mcastGroup = mcastGroup.substr(0, pos);
+            }
+        }
+        else if (std::strcmp(argv[i],"--mcast-if")==0 && i+1<argc) mcastIf = argv[++i];
+        else if (std::strcmp(argv[i],"--mcast-ttl")==0 && i+1<argc) mcastTtl = std::stoi(argv[++i]);
+        else if (std::strcmp(argv[i],"--mcast-loop")==0) mcastLoop = true;
+        else if (std::strcmp(argv[i],"--pace")==0) pace.enabled = true;
+        else if (std::strcmp(argv[i],"--pace-factor")==0 && i+1<argc) { pace.enabled = true; pace.pacingFactor = std::stod(argv[++i]); }
+        else if (std::strcmp(argv[i],"--pace-ms")==0 && i+1<argc) { pace.enabled = true; pace.flushMs = std::stoi(argv[++i]); }
         else if (std::strcmp(argv[i],"--list")==0) listOnly = true;
     }
 
     if (listOnly) { listDevices(); return 0; }
 
+    if (!traceEvents.empty()) {
+        EventTracer::instance().enable(true);
+        EventTracer::instance().setThreadName("main");
+        std::signal(SIGUSR1, onSignal);
+    }
+    if (!traceEvents.empty() || !traceOut.empty()) {
+        std::signal(SIGINT, onSignal);
+        std::signal(SIGTERM, onSignal);
+    }
+
     UdpTransport tr(localPort, remoteIp, remotePort);
+    tr.enableKernelTimestamps(!traceOut.empty());
+    // Multicast: gruba katıl, konuşmanın paketlerini gruba yolla (tek gönderim, tüm segment)
+    const uint32_t convId = 42;
+    if (!mcastGroup.empty()) {
+        tr.setMulticastTtl(mcastTtl);
+        tr.setMulticastLoopback(mcastLoop);
+        if (!mcastIf.empty()) tr.setMulticastInterface(mcastIf);
+        if (!tr.joinGroup(mcastGroup, mcastIf) || !tr.mapConvToGroup(convId, mcastGroup, mcastPort)) {
+            std::cerr << "multicast setup failed: " << mcastGroup << "\n"; return 1;
+        }
+    }
     if (!tr.start()) { std::cerr<<"UDP start failed\n"; return 1; }
 
+    // Paket izi: teldeki her datagram (RX/TX, parity dahil) dosyaya yazılır
+    PacketTraceWriter traceWriter;
+    ITransport* engineTr = &tr;
+    std::unique_ptr<TraceTransport> traceTr;
+    if (!traceOut.empty() && traceWriter.open(traceOut)) {
+        traceTr = std::make_unique<TraceTransport>(&tr, &traceWriter);
+        engineTr = traceTr.get();
+    }
+    // Pacer izin üstünde: iz, paketlerin tele çıktığı (pacing sonrası) anı kaydeder
+    std::unique_ptr<PacerTransport> pacer;
+    if (pace.enabled) {
+        pacer = std::make_unique<PacerTransport>(engineTr, pace);
+        pacer->start();
+        engineTr = pacer.get();
+    }
+    // FEC en üstte: engine -> FEC -> (pacer) -> (trace) -> UDP
+    std::unique_ptr<FecTransport> fecTr;
+    if (fec.enabled) {
+        fecTr = std::make_unique<FecTransport>(engineTr, fec);
+        engineTr = fecTr.get();
+    }
+
     VoiceEngine ve;
     if (inIdx>=0 || outIdx>=0) ve.setDevices(inIdx, outIdx);
     VoiceParams vp; // FEC hep açık; DTX=false debug
+    vp.governor.enabled = governor;
+    vp.governor.budgetUs = cpuBudgetUs;
+    vp.governor.adaptBandwidth = governBw;
+    vp.preproc = pp;
+    vp.playout = playout;
+    vp.stretch = stretch;
     if (echoPort) ve.enableEchoServer(echoPort);
     if (!rttTarget.empty()){
         auto pos = rttTarget.find(':');
@@ -69,7 +191,7 @@ int main(int argc, char** argv){
         }
     }
 
-    if (!ve.init(vp, &tr, 42)) { std::cerr<<"Voice init failed\n"; return 1; }
+    if (!ve.init(vp, engineTr, convId)) { std::cerr<<"Voice init failed\n"; return 1; }
     ve.setLocalEcho(echo);
     ve.setBypassVad(bypass);
 
@@ -79,10 +201,15 @@ int main(int argc, char** argv){
     uint64_t lastTx=0, lastRx=0;
     auto t0 = std::chrono::steady_clock::now();
 
-    while (true) {
+    while (!gStopReq) {
         ve.pollOnce();
         std::this_thread::sleep_for(std::chrono::milliseconds(5));
 
+        if (!traceEvents.empty() && (gDumpReq.exchange(false) || gStopReq)) {
+            long n = EventTracer::instance().dumpChromeJson(traceEvents);
+            if (n >= 0) std::cout << "[trace] " << n << " olay -> " << traceEvents << "\n";
+        }
+
         auto now = std::chrono::steady_clock::now();
         if (std::chrono::duration_cast<std::chrono::milliseconds>(now - t0).count() >= 1000) {
             uint64_t tx = ve.txFrames();
@@ -90,8 +217,45 @@ int main(int argc, char** argv){
             double rtt = ve.rttMs();
             std::cout << "[stats] TX="<<tx<<" (+"<<(tx-lastTx)<<")  RX="<<rx<<" (+"<<(rx-lastRx)<<")";
             if (rtt>=0) std::cout << "  rtt≈" << (int)rtt << "ms";
+            GovernorStats gs = ve.governorStats();
+            std::cout << "  cx=" << gs.complexity << " enc=" << (int)gs.encodeUs << "us"
+                      << " dec=" << (int)gs.decodeUs << "us/" << (int)gs.budgetUs << "us";
+            if (gs.cpuBusy>=0) std::cout << " cpu=" << (int)(gs.cpuBusy*100) << "%";
+            PlayoutStats ps = ve.playoutStats();
+            std::cout << "  play=" << (int)ps.queuedMs << "ms ur=" << ps.underruns;
+            if (stretch.enabled) {
+                TimeStretchStats ts = ve.stretchStats();
+                std::cout << "  tsm=" << ts.rate << "x drift=" << (int)ts.driftPpm << "ppm"
+                          << " jb=" << (int)ts.depthMs << "/" << (int)ts.targetMs << "ms";
+            }
+            if (!mcastGroup.empty()) std::cout << "  mcast dup=" << tr.duplicatesDropped();
+            if (fecTr) {
+                FecStats fs = fecTr->stats();
+                std::cout << "  fec=" << (fs.active ? "on" : "off");
+                if (fs.active) std::cout << " " << fs.k << "+" << fs.m << "x" << fs.interleave;
+                std::cout << " rec=" << fs.recovered << " late=" << fs.recoveredLate << " par=" << fs.paritySent
+                          << " peerLoss=" << (int)(fs.peerLoss*100) << "%";
+            }
+            if (pacer) {
+                PacerStats st = pacer->stats();
+                uint64_t q = 0, d = 0;
+                for (int c=0;c<PACE_CLASSES;++c) { q += st.queued[c]; d += st.dropped[c]; }
+                std::cout << "  pace=" << st.rateBps/1000 << "k q=" << q << " drop=" << d
+                          << " wait=" << (int)st.maxWaitMs << "ms";
+            }
+            if (preStats) {
+                std::cout << "  pre[";
+                for (const auto& t : ve.preprocessTimings())
+                    std::cout << " " << t.name << "=" << (int)t.avgUs << "/" << (int)t.maxUs << "us";
+                std::cout << " ]";
+            }
             std::cout << "\n";
             lastTx = tx; lastRx = rx; t0 = now;
         }
     }
+    ve.shutdown();
+    if (pacer) pacer->stop();
+    tr.stop();
+    traceWriter.close();
+    return 0;
 }